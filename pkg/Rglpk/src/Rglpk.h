@@ -1,6 +1,250 @@
 #include "glpk.h"
 #include <R.h>
 #include <Rinternals.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// formats of the constraint matrix
+#define RGLPK_MAT_TRIPLET 1
+#define RGLPK_MAT_CSC 2
+#define RGLPK_MAT_DENSE 3
+
+// problem data passed down from R, see Rglpk_data_init(). The
+// constraint matrix is given as triplets ('mat_i', 'mat_j', 'mat_v'),
+// in compressed sparse column form ('mat_p', 0-based row indices
+// 'mat_i', 'mat_v'), or as dense matrix in column-major order
+// ('mat_v'). Ranged constraints (direction 0) have lower bounds
+// 'lhs', which is NULL if there are none.
+typedef struct {
+  int maximize;
+  int n_rows, n_cols, n_nz;
+  const double *obj;
+  // types are recycled, bounds are NULL if all take the default (see
+  // Rglpk_bounds_init())
+  const int *kind;
+  int n_kind;
+  const double *bounds_lower, *bounds_upper;
+  const int *dir;
+  const double *rhs, *lhs;
+  int mat_format;
+  const int *mat_i, *mat_j, *mat_p;
+  const double *mat_v;
+} Rglpk_data;
+
+// LP methods
+#define RGLPK_SIMPLEX 1
+#define RGLPK_INTERIOR 2
+#define RGLPK_INTERIOR_CROSSOVER 3
+
+// warm starts of the simplex from the current basis, see
+// Rglpk_run_solver()
+#define RGLPK_WARM_DUAL 1
+#define RGLPK_WARM_PRIMAL 2
+
+// native lazy constraint separator (control parameter 'lazy'), see
+// Rglpk_lazy.c. It is called with the 'n' column values 'x' of the LP
+// relaxation of the current subproblem and adds violated rows via
+// 'add_row', passing on 'info'. Column indices are 1-based and unique
+// within a row, 'dir' is coded as in glp_match_dir() on the R level
+// (1 '<', ..., 5 '=='). An invalid row terminates the search.
+typedef void (*Rglpk_add_row_fn)(void *info, int len, const int *ind,
+                                 const double *val, int dir, double rhs);
+typedef void (*Rglpk_separator)(int n, const double *x,
+                                Rglpk_add_row_fn add_row, void *info);
+
+// solver control parameters, see Rglpk_control_init()
+typedef struct {
+  int verbose;
+  int method;
+  int presolve;
+  int tm_limit;
+  // wall clock time (see Rglpk_wall_time()) at which the solve is
+  // stopped, 0 if there is no time limit, see Rglpk_control_deadline()
+  double deadline;
+  // set if the user interrupted the branch-and-cut solver, NULL if
+  // interrupts are not checked (as when solving in parallel)
+  int *interrupted;
+  // branch-and-cut parameters, negative values select GLPK's defaults
+  double mip_gap;
+  int br_tech, bt_tech, pp_tech;
+  int gmi_cuts, mir_cuts, cov_cuts, clq_cuts;
+  int fp_heur, ps_heur;
+  int out_frq;
+  // starting basis (GLPK status codes), NULL if not given
+  const int *col_stat, *row_stat;
+  int n_col_stat, n_row_stat;
+  // (partial) MIP start, NA for values not given, NULL if not given
+  const double *start;
+  int n_start;
+  // sensitivity analysis: requested at all, rows and columns (all if
+  // NULL)
+  int sensitivity;
+  const int *sens_rows, *sens_cols;
+  int n_sens_rows, n_sens_cols;
+  // look up and store solutions in the solution cache
+  int cache;
+  // return statistics of the solve
+  int stats;
+  // record the progress of the branch-and-cut solver every
+  // 'progress_interval' seconds, retaining 'progress_size' records (0
+  // if not requested) and calling R function 'progress_callback' (if
+  // not R_NilValue)
+  double progress_interval;
+  int progress_size;
+  SEXP progress_callback;
+  // lazy constraint separator, either an R function (R_NilValue if
+  // not given) or a native one (NULL if not given)
+  SEXP lazy;
+  Rglpk_separator lazy_native;
+} Rglpk_control;
+
+// key of the solution cache, see Rglpk_cache_key_init(). The problem
+// and the parameters it was computed from have to stay valid while the
+// key is used.
+typedef struct {
+  unsigned long long structure, data;
+  int m, n, nnz;
+  const Rglpk_data *problem;
+  const Rglpk_control *control;
+  size_t record_size;
+} Rglpk_cache_key;
+
+// phases of a solve timed in Rglpk_stats
+#define RGLPK_PHASE_VALIDATE 0
+#define RGLPK_PHASE_BUILD 1
+#define RGLPK_PHASE_LP 2
+#define RGLPK_PHASE_MIP 3
+#define RGLPK_PHASE_EXTRACT 4
+#define RGLPK_N_PHASES 5
+
+// statistics of a solve, see Rglpk_stats_init(). Counters not
+// available are NA.
+typedef struct {
+  double wall[RGLPK_N_PHASES], cpu[RGLPK_N_PHASES];
+  double wall_start, cpu_start;
+  int iterations, nodes, active_nodes;
+  double mip_gap, best_bound;
+  int cached;
+} Rglpk_stats;
+
+// progress of the branch-and-cut solver, see Rglpk_progress_init()
+typedef struct {
+  int size, count;
+  double interval, start, last;
+  int incumbent_seen;
+  double last_incumbent;
+  double *time, *incumbent, *bound, *gap;
+  int *active_nodes, *nodes, *event;
+  SEXP callback;
+  int failed;
+} Rglpk_progress;
+
+// solution retrieved from a problem object, see Rglpk_solution_list()
+typedef struct {
+  int status;
+  double optimum;
+  int m, n, type;
+  double *x, *x_dual, *row, *row_dual;
+  int *col_stat, *row_stat;
+} Rglpk_solution;
+
+// problem data of a file, see Rglpk_MP_list(). The arrays either
+// point into the vectors of the R list returned to R or into memory
+// allocated by Rglpk_MP_read() (in which case they are owned by the
+// structure and released via Rglpk_MP_free()).
+typedef struct {
+  int status;
+  int maximize, m, n, nnz, n_int, n_bin;
+  const char *problem_name, *objective_name;
+  double *obj, *mat_v, *rhs, *lhs, *lower, *upper;
+  int *mat_i, *mat_j, *dir, *is_int, *is_bin;
+  const char **row_names, **col_names;
+  char *pool;
+} Rglpk_MP;
+
+// model data held in memory streamed to GLPK's file readers, see
+// Rglpk_stream_open()
+typedef struct {
+  int active;
+  char path[32];
+#ifndef _WIN32
+  const char *buf;
+  size_t size;
+  int fd[2];
+  volatile int stop;
+  pthread_t writer;
+#endif
+} Rglpk_stream;
+
+// incremented whenever the GLPK environment is freed
+extern unsigned int Rglpk_env_generation;
 
 void Rglpk_initialize(void);
 void Rglpk_error_hook(void *in);
+void Rglpk_thread_error_hook(void *in);
+int Rglpk_thread_safe(void);
+
+SEXP Rglpk_get_elt(SEXP list, const char *name);
+void Rglpk_data_init(Rglpk_data *data, SEXP x);
+void Rglpk_data_load(glp_prob *lp, const Rglpk_data *data);
+void Rglpk_bounds_init(SEXP x, int n, const double **lower,
+                       const double **upper);
+void Rglpk_cols_check(int n, const int *kind, int n_kind,
+                      const double *lower, const double *upper);
+int Rglpk_bound_type(double lb, double ub);
+void Rglpk_row_check(int k, int dir, double lhs, double rhs);
+int Rglpk_row_valid(int dir, double lhs, double rhs);
+int Rglpk_row_bounds(int dir, double lhs, double rhs, double *lb, double *ub);
+void Rglpk_set_row(glp_prob *lp, int i, int dir, double lhs, double rhs);
+void Rglpk_set_cols(glp_prob *lp, int first, int n, const double *obj,
+                    const int *kind, int n_kind, const double *bounds_lower,
+                    const double *bounds_upper);
+void Rglpk_control_init(Rglpk_control *control, SEXP x);
+void Rglpk_control_check(const Rglpk_control *control, int m, int n);
+void Rglpk_control_deadline(Rglpk_control *control);
+
+SEXP Rglpk_model_wrap(glp_prob *lp);
+void Rglpk_model_delete(SEXP ptr);
+
+int Rglpk_run_solver(glp_prob *lp, const Rglpk_control *control, int warm,
+                     Rglpk_stats *stats, Rglpk_progress *progress);
+int Rglpk_user_interrupt(void);
+int Rglpk_solution_type(glp_prob *lp, const Rglpk_control *control);
+SEXP Rglpk_get_solution(glp_prob *lp, int type);
+SEXP Rglpk_termination(glp_prob *lp, int ret, const Rglpk_control *control,
+                       const Rglpk_stats *stats);
+SEXP Rglpk_solution_list(int m, int n, int type, Rglpk_solution *sol);
+void Rglpk_solution_extract(glp_prob *lp, Rglpk_solution *sol);
+void Rglpk_solution_finish(SEXP out, const Rglpk_solution *sol);
+
+SEXP Rglpk_sensitivity(glp_prob *lp, const Rglpk_control *control);
+
+double Rglpk_wall_time(void);
+double Rglpk_cpu_time(void);
+void Rglpk_stats_init(Rglpk_stats *stats);
+void Rglpk_stats_start(Rglpk_stats *stats);
+void Rglpk_stats_phase(Rglpk_stats *stats, int phase);
+int Rglpk_iteration_count(glp_prob *lp);
+SEXP Rglpk_stats_list(const Rglpk_stats *stats);
+
+int Rglpk_lazy_given(const Rglpk_control *control);
+int Rglpk_lazy_separate(glp_tree *tree, const Rglpk_control *control,
+                        double *x, int *mark);
+
+void Rglpk_progress_init(Rglpk_progress *progress,
+                         const Rglpk_control *control);
+void Rglpk_progress_update(Rglpk_progress *progress, glp_tree *tree);
+SEXP Rglpk_progress_list(const Rglpk_progress *progress);
+
+void Rglpk_cache_key_init(Rglpk_cache_key *key, const Rglpk_data *data,
+                          const Rglpk_control *ctrl);
+SEXP Rglpk_cache_lookup(const Rglpk_cache_key *key, SEXP *near);
+void Rglpk_cache_insert(const Rglpk_cache_key *key, SEXP value);
+
+int Rglpk_read_prob(glp_prob *lp, int type, const char *file,
+                    const char *data);
+int Rglpk_stream_open(Rglpk_stream *stream, const char *buf, size_t size);
+void Rglpk_stream_close(Rglpk_stream *stream);
+SEXP Rglpk_MP_list(const Rglpk_MP *mp, Rglpk_MP *bind);
+SEXP Rglpk_retrieve_MP(glp_prob *lp, int ignore_first_row, int names);
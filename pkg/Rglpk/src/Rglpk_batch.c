@@ -0,0 +1,190 @@
+/* Solving many independent problems in parallel. The problem data is
+ * converted on the main thread, the problems are then loaded and
+ * solved on an OpenMP thread pool, each thread using its own GLPK
+ * environment. Solutions are collected in malloc()ed buffers and
+ * handed over to R on the main thread afterwards.
+ */
+
+#include "Rglpk.h"
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// state of a single problem of a batch. 'status' is 0 on success, 2
+// if an error occured inside the GLPK library, and 3 if running out
+// of memory.
+typedef struct {
+  Rglpk_data data;
+  Rglpk_control control;
+  Rglpk_solution sol;
+  int status;
+} Rglpk_job;
+
+typedef struct {
+  int n;
+  Rglpk_job *jobs;
+} Rglpk_batch;
+
+static void Rglpk_job_free(Rglpk_job *job) {
+  free(job->sol.x);
+  free(job->sol.x_dual);
+  free(job->sol.row);
+  free(job->sol.row_dual);
+  free(job->sol.col_stat);
+  free(job->sol.row_stat);
+  memset(&job->sol, 0, sizeof(Rglpk_solution));
+}
+
+static void Rglpk_batch_finalize(SEXP ptr) {
+  Rglpk_batch *batch = (Rglpk_batch *) R_ExternalPtrAddr(ptr);
+  int k;
+
+  if (!batch)
+    return;
+  for (k = 0; k < batch->n; k++)
+    Rglpk_job_free(&batch->jobs[k]);
+  R_Free(batch->jobs);
+  R_Free(batch);
+  R_ClearExternalPtr(ptr);
+}
+
+// load and solve a single problem. This runs in parallel, hence
+// neither the R API nor R's memory allocation must be used.
+static void Rglpk_job_run(Rglpk_job *job, int main) {
+  Rglpk_solution *sol = &job->sol;
+  glp_prob *lp;
+  jmp_buf env;
+
+  if (setjmp(env)) {
+    // the problem object is gone with the environment
+    Rglpk_job_free(job);
+    job->status = 2;
+    return;
+  }
+  glp_error_hook(main ? Rglpk_error_hook : Rglpk_thread_error_hook, &env);
+  glp_term_out(GLP_OFF);
+  // the time limit of each problem starts with its own solve
+  Rglpk_control_deadline(&job->control);
+
+  lp = glp_create_prob();
+  Rglpk_data_load(lp, &job->data);
+  Rglpk_run_solver(lp, &job->control, 0, NULL, NULL);
+
+  sol->m = job->data.n_rows;
+  sol->n = job->data.n_cols;
+  sol->type = Rglpk_solution_type(lp, &job->control);
+  // calloc() such that zero sized arrays are no special case
+  sol->x = (double *) calloc(sol->n + 1, sizeof(double));
+  sol->row = (double *) calloc(sol->m + 1, sizeof(double));
+  if (sol->type != GLP_MIP) {
+    sol->x_dual = (double *) calloc(sol->n + 1, sizeof(double));
+    sol->row_dual = (double *) calloc(sol->m + 1, sizeof(double));
+  }
+  if (sol->type == GLP_SOL) {
+    sol->col_stat = (int *) calloc(sol->n + 1, sizeof(int));
+    sol->row_stat = (int *) calloc(sol->m + 1, sizeof(int));
+  }
+  if (!sol->x || !sol->row ||
+      (sol->type != GLP_MIP && (!sol->x_dual || !sol->row_dual)) ||
+      (sol->type == GLP_SOL && (!sol->col_stat || !sol->row_stat))) {
+    glp_delete_prob(lp);
+    Rglpk_job_free(job);
+    job->status = 3;
+    return;
+  }
+  Rglpk_solution_extract(lp, sol);
+  glp_delete_prob(lp);
+  job->status = 0;
+}
+
+// solve the problems given in the list 'x' (each as prepared by
+// glp_prepare_MP()) using up to 'threads' threads (all available if
+// not positive). 'tm_limit' holds the time limit of each problem.
+// Returns a list of solutions in the order of 'x', NULL elements for
+// problems which could not be solved and the vector of status codes
+// (see Rglpk_job) as attribute "status".
+SEXP R_glp_solve_batch(SEXP x, SEXP control, SEXP tm_limit, SEXP threads) {
+  int k, n = length(x), nthreads = asInteger(threads);
+  Rglpk_batch *batch;
+  Rglpk_solution sol;
+  Rglpk_job *job;
+  SEXP out, status, ptr, elt;
+
+  if (length(tm_limit) != n)
+    error("Argument 'tm_limit' must be of length %d.", n);
+
+  batch = R_Calloc(1, Rglpk_batch);
+  ptr = PROTECT(R_MakeExternalPtr(batch, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, Rglpk_batch_finalize, TRUE);
+  batch->jobs = R_Calloc(n, Rglpk_job);
+  batch->n = n;
+
+  // all type, length and NA checks happen here, before any GLPK
+  // object is created
+  for (k = 0; k < n; k++) {
+    job = &batch->jobs[k];
+    Rglpk_data_init(&job->data, VECTOR_ELT(x, k));
+    Rglpk_control_init(&job->control, control);
+    Rglpk_control_check(&job->control, job->data.n_rows, job->data.n_cols);
+    // separators may call R
+    if (Rglpk_lazy_given(&job->control))
+      error("Lazy constraints are not available for batch solves.");
+    job->control.verbose = 0;
+    job->control.tm_limit = INTEGER(tm_limit)[k] > 0 ? INTEGER(tm_limit)[k] : 0;
+  }
+
+#ifdef _OPENMP
+  if (nthreads == NA_INTEGER || nthreads < 1)
+    nthreads = omp_get_max_threads();
+  // GLPK shares one environment between all threads otherwise
+  if (!Rglpk_thread_safe())
+    nthreads = 1;
+#pragma omp parallel num_threads(nthreads)
+  {
+    // each thread solves in its own GLPK environment
+    int main = omp_get_thread_num() == 0;
+    // problems are handed out one at a time such that a few long
+    // running problems do not hold up the others
+#pragma omp for schedule(dynamic, 1)
+    for (k = 0; k < n; k++)
+      Rglpk_job_run(&batch->jobs[k], main);
+    // the main thread's environment holds the problem objects alive on
+    // the R level and must be kept
+    if (!main)
+      glp_free_env();
+  }
+#else
+  for (k = 0; k < n; k++)
+    Rglpk_job_run(&batch->jobs[k], 1);
+#endif
+
+  out = PROTECT(allocVector(VECSXP, n));
+  status = PROTECT(allocVector(INTSXP, n));
+  for (k = 0; k < n; k++) {
+    job = &batch->jobs[k];
+    INTEGER(status)[k] = job->status;
+    if (job->status != 0)
+      continue;
+    elt = Rglpk_solution_list(job->sol.m, job->sol.n, job->sol.type, &sol);
+    SET_VECTOR_ELT(out, k, elt);
+    memcpy(sol.x, job->sol.x, sol.n * sizeof(double));
+    memcpy(sol.row, job->sol.row, sol.m * sizeof(double));
+    if (sol.type != GLP_MIP) {
+      memcpy(sol.x_dual, job->sol.x_dual, sol.n * sizeof(double));
+      memcpy(sol.row_dual, job->sol.row_dual, sol.m * sizeof(double));
+    }
+    if (sol.type == GLP_SOL) {
+      memcpy(sol.col_stat, job->sol.col_stat, sol.n * sizeof(int));
+      memcpy(sol.row_stat, job->sol.row_stat, sol.m * sizeof(int));
+    }
+    Rglpk_solution_finish(elt, &job->sol);
+    Rglpk_job_free(job);
+  }
+  setAttrib(out, install("status"), status);
+  Rglpk_batch_finalize(ptr);
+  UNPROTECT(3);
+  return out;
+}
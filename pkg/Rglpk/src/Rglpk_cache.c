@@ -0,0 +1,422 @@
+/* Cache of solutions of Rglpk_solve_LP() (control parameter 'cache').
+ * Problems are identified by two 64-bit hashes: one of the structure
+ * (dimensions, sparsity pattern of the constraint matrix, and column
+ * kinds) and one of the numeric data and the solver parameters. If
+ * both match, the problem data and parameters stored with the entry
+ * are compared as well, such that hash collisions are detected, and
+ * only then the stored solution is returned without calling GLPK. If
+ * only the structure matches, the stored basis is used to warm start
+ * the simplex method.
+ *
+ * Entries are kept in a list in order of their last use and evicted
+ * from its tail once the estimated size of the stored solutions
+ * exceeds the budget.
+ */
+
+#include "Rglpk.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RGLPK_CACHE_BUDGET (64.0 * 1024 * 1024)
+// approximate size of the header of an R vector
+#define RGLPK_VECTOR_HEADER 48
+
+typedef struct Rglpk_cache_entry {
+  Rglpk_cache_key key;
+  // the problem data and parameters, see Rglpk_cache_record()
+  unsigned char *record;
+  SEXP value;
+  double size;
+  struct Rglpk_cache_entry *prev, *next;
+} Rglpk_cache_entry;
+
+static struct {
+  Rglpk_cache_entry *head, *tail;
+  int n_entries;
+  double size, budget;
+  double hits, near_hits, misses, evictions;
+} Rglpk_cache = {NULL, NULL, 0, 0.0, RGLPK_CACHE_BUDGET, 0.0, 0.0, 0.0, 0.0};
+
+// hashing, words are mixed in 8 bytes at a time
+static uint64_t Rglpk_hash_mix(uint64_t h, uint64_t w) {
+  h ^= w * 0x9e3779b97f4a7c15ULL;
+  h = (h << 31) | (h >> 33);
+  return h * 0xbf58476d1ce4e5b9ULL;
+}
+
+static uint64_t Rglpk_hash_bytes(uint64_t h, const void *p, size_t len) {
+  const unsigned char *s = (const unsigned char *) p;
+  uint64_t w;
+
+  h = Rglpk_hash_mix(h, len);
+  for (; len >= 8; s += 8, len -= 8) {
+    memcpy(&w, s, 8);
+    h = Rglpk_hash_mix(h, w);
+  }
+  if (len > 0) {
+    w = 0;
+    memcpy(&w, s, len);
+    h = Rglpk_hash_mix(h, w);
+  }
+  return h;
+}
+
+static uint64_t Rglpk_hash_final(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  return h ^ (h >> 33);
+}
+
+#define RGLPK_HASH_INTS(h, x, n) \
+  Rglpk_hash_bytes(h, x, (x) ? (size_t) (n) * sizeof(int) : 0)
+#define RGLPK_HASH_REALS(h, x, n) \
+  Rglpk_hash_bytes(h, x, (x) ? (size_t) (n) * sizeof(double) : 0)
+
+// hash of the non-zero pattern of a dense matrix, one bit per element
+static uint64_t Rglpk_hash_dense_pattern(uint64_t h, const double *v,
+                                         size_t len) {
+  uint64_t w = 0;
+  size_t k;
+
+  for (k = 0; k < len; k++) {
+    if (v[k] != 0.0)
+      w |= (uint64_t) 1 << (k & 63);
+    if ((k & 63) == 63) {
+      h = Rglpk_hash_mix(h, w);
+      w = 0;
+    }
+  }
+  return Rglpk_hash_mix(h, w);
+}
+
+// parameters which may change the solution, 'verbose' and 'out_frq'
+// only affect the output and 'tm_limit' only whether a solve is
+// completed (solutions of runs stopped by a limit are not stored)
+#define RGLPK_CONTROL_PAR(ctrl) {                                       \
+    (ctrl)->method, (ctrl)->presolve, (ctrl)->br_tech, (ctrl)->bt_tech, \
+    (ctrl)->pp_tech, (ctrl)->gmi_cuts, (ctrl)->mir_cuts,                \
+    (ctrl)->cov_cuts, (ctrl)->clq_cuts, (ctrl)->fp_heur,                \
+    (ctrl)->ps_heur, (ctrl)->sensitivity, (ctrl)->n_col_stat,           \
+    (ctrl)->n_row_stat, (ctrl)->n_start, (ctrl)->n_sens_rows,           \
+    (ctrl)->n_sens_cols}
+
+static uint64_t Rglpk_hash_control(uint64_t h, const Rglpk_control *ctrl) {
+  int par[] = RGLPK_CONTROL_PAR(ctrl);
+
+  h = Rglpk_hash_bytes(h, par, sizeof(par));
+  h = Rglpk_hash_bytes(h, &ctrl->mip_gap, sizeof(double));
+  h = RGLPK_HASH_INTS(h, ctrl->col_stat, ctrl->n_col_stat);
+  h = RGLPK_HASH_INTS(h, ctrl->row_stat, ctrl->n_row_stat);
+  h = RGLPK_HASH_REALS(h, ctrl->start, ctrl->n_start);
+  h = RGLPK_HASH_INTS(h, ctrl->sens_rows, ctrl->n_sens_rows);
+  return RGLPK_HASH_INTS(h, ctrl->sens_cols, ctrl->n_sens_cols);
+}
+
+// record of the problem data and parameters of a key: the arrays
+// hashed into the key, each preceded by its length. Written to 'out'
+// if not NULL, compared to 'cmp' if not NULL. Returns the size of the
+// record, or 0 if it differs from 'cmp'.
+typedef struct {
+  unsigned char *out;
+  const unsigned char *cmp;
+  size_t len;
+  int differs;
+} Rglpk_record;
+
+static void Rglpk_record_bytes(Rglpk_record *r, const void *p, size_t n) {
+  if (r->out)
+    memcpy(r->out + r->len, p, n);
+  if (r->cmp && !r->differs && memcmp(r->cmp + r->len, p, n))
+    r->differs = 1;
+  r->len += n;
+}
+
+// the length comes first, hence records of different lengths are
+// compared no further than to the first differing length
+static void Rglpk_record_put(Rglpk_record *r, const void *p, size_t len) {
+  Rglpk_record_bytes(r, &len, sizeof(size_t));
+  if (len > 0)
+    Rglpk_record_bytes(r, p, len);
+}
+
+#define RGLPK_RECORD_INTS(r, x, n) \
+  Rglpk_record_put(r, x, (x) ? (size_t) (n) * sizeof(int) : 0)
+#define RGLPK_RECORD_REALS(r, x, n) \
+  Rglpk_record_put(r, x, (x) ? (size_t) (n) * sizeof(double) : 0)
+
+static size_t Rglpk_cache_record(const Rglpk_cache_key *key,
+                                 unsigned char *out,
+                                 const unsigned char *cmp) {
+  const Rglpk_data *data = key->problem;
+  const Rglpk_control *ctrl = key->control;
+  size_t m = data->n_rows, n = data->n_cols;
+  int dims[] = {data->n_rows, data->n_cols, data->n_nz, data->mat_format,
+                data->n_kind, data->maximize};
+  int par[] = RGLPK_CONTROL_PAR(ctrl);
+  Rglpk_record r = {out, cmp, 0, 0};
+
+  Rglpk_record_put(&r, dims, sizeof(dims));
+  RGLPK_RECORD_INTS(&r, data->kind, data->n_kind);
+  switch (data->mat_format) {
+  case RGLPK_MAT_DENSE:
+    break;
+  case RGLPK_MAT_CSC:
+    RGLPK_RECORD_INTS(&r, data->mat_p, n + 1);
+    RGLPK_RECORD_INTS(&r, data->mat_i, data->n_nz);
+    break;
+  default:
+    RGLPK_RECORD_INTS(&r, data->mat_i, data->n_nz);
+    RGLPK_RECORD_INTS(&r, data->mat_j, data->n_nz);
+  }
+  RGLPK_RECORD_REALS(&r, data->obj, n);
+  RGLPK_RECORD_INTS(&r, data->dir, m);
+  RGLPK_RECORD_REALS(&r, data->rhs, m);
+  RGLPK_RECORD_REALS(&r, data->lhs, m);
+  RGLPK_RECORD_REALS(&r, data->bounds_lower, n);
+  RGLPK_RECORD_REALS(&r, data->bounds_upper, n);
+  RGLPK_RECORD_REALS(&r, data->mat_v, data->mat_format == RGLPK_MAT_DENSE ?
+                     m * n : (size_t) data->n_nz);
+  Rglpk_record_put(&r, par, sizeof(par));
+  Rglpk_record_put(&r, &ctrl->mip_gap, sizeof(double));
+  RGLPK_RECORD_INTS(&r, ctrl->col_stat, ctrl->n_col_stat);
+  RGLPK_RECORD_INTS(&r, ctrl->row_stat, ctrl->n_row_stat);
+  RGLPK_RECORD_REALS(&r, ctrl->start, ctrl->n_start);
+  RGLPK_RECORD_INTS(&r, ctrl->sens_rows, ctrl->n_sens_rows);
+  RGLPK_RECORD_INTS(&r, ctrl->sens_cols, ctrl->n_sens_cols);
+  return r.differs ? 0 : r.len;
+}
+
+// compute the cache key of problem 'data' solved with 'ctrl'
+void Rglpk_cache_key_init(Rglpk_cache_key *key, const Rglpk_data *data,
+                          const Rglpk_control *ctrl) {
+  size_t m = data->n_rows, n = data->n_cols;
+  int dims[] = {data->n_rows, data->n_cols, data->n_nz, data->mat_format,
+                data->n_kind};
+  uint64_t s = 0, d = 0;
+
+  key->m = data->n_rows;
+  key->n = data->n_cols;
+  key->nnz = data->n_nz;
+  key->problem = data;
+  key->control = ctrl;
+
+  // structure
+  s = Rglpk_hash_bytes(s, dims, sizeof(dims));
+  s = RGLPK_HASH_INTS(s, data->kind, data->n_kind);
+  switch (data->mat_format) {
+  case RGLPK_MAT_DENSE:
+    s = Rglpk_hash_dense_pattern(s, data->mat_v, m * n);
+    break;
+  case RGLPK_MAT_CSC:
+    s = RGLPK_HASH_INTS(s, data->mat_p, n + 1);
+    s = RGLPK_HASH_INTS(s, data->mat_i, data->n_nz);
+    break;
+  default:
+    s = RGLPK_HASH_INTS(s, data->mat_i, data->n_nz);
+    s = RGLPK_HASH_INTS(s, data->mat_j, data->n_nz);
+  }
+
+  // numeric data, missing bounds and left hand sides hash differently
+  // from given ones
+  d = Rglpk_hash_bytes(d, &data->maximize, sizeof(int));
+  d = RGLPK_HASH_REALS(d, data->obj, n);
+  d = RGLPK_HASH_INTS(d, data->dir, m);
+  d = RGLPK_HASH_REALS(d, data->rhs, m);
+  d = RGLPK_HASH_REALS(d, data->lhs, m);
+  d = RGLPK_HASH_REALS(d, data->bounds_lower, n);
+  d = RGLPK_HASH_REALS(d, data->bounds_upper, n);
+  d = RGLPK_HASH_REALS(d, data->mat_v, data->mat_format == RGLPK_MAT_DENSE ?
+                       m * n : (size_t) data->n_nz);
+  d = Rglpk_hash_control(d, ctrl);
+
+  key->structure = Rglpk_hash_final(s);
+  key->data = Rglpk_hash_final(d ^ key->structure);
+  key->record_size = Rglpk_cache_record(key, NULL, NULL);
+}
+
+static int Rglpk_cache_same_structure(const Rglpk_cache_key *a,
+                                      const Rglpk_cache_key *b) {
+  return a->structure == b->structure && a->m == b->m && a->n == b->n &&
+    a->nnz == b->nnz;
+}
+
+// estimated memory used by a stored solution
+static double Rglpk_object_size(SEXP x) {
+  double size = RGLPK_VECTOR_HEADER;
+  R_xlen_t k;
+
+  switch (TYPEOF(x)) {
+  case VECSXP:
+    for (k = 0; k < XLENGTH(x); k++)
+      size += sizeof(SEXP) + Rglpk_object_size(VECTOR_ELT(x, k));
+    break;
+  case REALSXP:
+    size += XLENGTH(x) * sizeof(double);
+    break;
+  case INTSXP:
+  case LGLSXP:
+    size += XLENGTH(x) * sizeof(int);
+    break;
+  case STRSXP:
+    size += XLENGTH(x) * sizeof(SEXP);
+    break;
+  default:
+    break;
+  }
+  if (TYPEOF(x) == VECSXP)
+    size += Rglpk_object_size(getAttrib(x, install("sensitivity")));
+  return size;
+}
+
+static void Rglpk_cache_unlink(Rglpk_cache_entry *e) {
+  if (e->prev)
+    e->prev->next = e->next;
+  else
+    Rglpk_cache.head = e->next;
+  if (e->next)
+    e->next->prev = e->prev;
+  else
+    Rglpk_cache.tail = e->prev;
+  e->prev = e->next = NULL;
+}
+
+static void Rglpk_cache_push(Rglpk_cache_entry *e) {
+  e->prev = NULL;
+  e->next = Rglpk_cache.head;
+  if (Rglpk_cache.head)
+    Rglpk_cache.head->prev = e;
+  Rglpk_cache.head = e;
+  if (!Rglpk_cache.tail)
+    Rglpk_cache.tail = e;
+}
+
+static void Rglpk_cache_remove(Rglpk_cache_entry *e) {
+  Rglpk_cache_unlink(e);
+  Rglpk_cache.size -= e->size;
+  Rglpk_cache.n_entries--;
+  R_ReleaseObject(e->value);
+  free(e->record);
+  free(e);
+}
+
+// evict least recently used entries until 'extra' bytes fit into the
+// budget
+static void Rglpk_cache_shrink(double extra) {
+  while (Rglpk_cache.tail && Rglpk_cache.size + extra > Rglpk_cache.budget) {
+    Rglpk_cache_remove(Rglpk_cache.tail);
+    Rglpk_cache.evictions++;
+  }
+}
+
+// look up 'key'. Returns the stored solution on an exact hit,
+// otherwise R_NilValue. On a near hit (same structure, different
+// data) '*near' is set to the solution of the most recently used
+// problem of the same structure, to R_NilValue otherwise.
+SEXP Rglpk_cache_lookup(const Rglpk_cache_key *key, SEXP *near) {
+  Rglpk_cache_entry *e;
+
+  *near = R_NilValue;
+  for (e = Rglpk_cache.head; e; e = e->next) {
+    if (!Rglpk_cache_same_structure(&e->key, key))
+      continue;
+    if (e->key.data == key->data &&
+        e->key.record_size == key->record_size &&
+        Rglpk_cache_record(key, NULL, e->record) == key->record_size) {
+      Rglpk_cache_unlink(e);
+      Rglpk_cache_push(e);
+      Rglpk_cache.hits++;
+      return e->value;
+    }
+    if (isNull(*near))
+      *near = e->value;
+  }
+  if (isNull(*near))
+    Rglpk_cache.misses++;
+  else
+    Rglpk_cache.near_hits++;
+  return R_NilValue;
+}
+
+// store solution 'value' of the problem identified by 'key'. Only
+// definite results are stored, i.e., not those of runs stopped by a
+// limit.
+void Rglpk_cache_insert(const Rglpk_cache_key *key, SEXP value) {
+  Rglpk_cache_entry *e;
+  int status = asInteger(VECTOR_ELT(value, 0));
+  double size;
+
+  if (status != GLP_OPT && status != GLP_NOFEAS && status != GLP_UNBND)
+    return;
+  size = sizeof(Rglpk_cache_entry) + key->record_size +
+    Rglpk_object_size(value);
+  if (size > Rglpk_cache.budget)
+    return;
+  e = (Rglpk_cache_entry *) malloc(sizeof(Rglpk_cache_entry));
+  if (!e)
+    return;
+  e->record = (unsigned char *) malloc(key->record_size);
+  if (!e->record) {
+    free(e);
+    return;
+  }
+  Rglpk_cache_shrink(size);
+  Rglpk_cache_record(key, e->record, NULL);
+  e->key = *key;
+  // the problem data is not referenced after the call
+  e->key.problem = NULL;
+  e->key.control = NULL;
+  e->value = value;
+  e->size = size;
+  MARK_NOT_MUTABLE(value);
+  R_PreserveObject(value);
+  Rglpk_cache_push(e);
+  Rglpk_cache.size += size;
+  Rglpk_cache.n_entries++;
+}
+
+SEXP R_glp_cache_stats(void) {
+  static const char *names[] = {"hits", "near_hits", "misses", "evictions",
+                                "entries", "size", "budget", ""};
+  SEXP out = PROTECT(allocVector(REALSXP, 7)), nms;
+  double *v = REAL(out);
+  int k;
+
+  v[0] = Rglpk_cache.hits;
+  v[1] = Rglpk_cache.near_hits;
+  v[2] = Rglpk_cache.misses;
+  v[3] = Rglpk_cache.evictions;
+  v[4] = Rglpk_cache.n_entries;
+  v[5] = Rglpk_cache.size;
+  v[6] = Rglpk_cache.budget;
+  nms = PROTECT(allocVector(STRSXP, 7));
+  for (k = 0; k < 7; k++)
+    SET_STRING_ELT(nms, k, mkChar(names[k]));
+  setAttrib(out, R_NamesSymbol, nms);
+  UNPROTECT(2);
+  return out;
+}
+
+// remove all entries, counters are reset unless 'keep_stats' is TRUE
+SEXP R_glp_cache_clear(SEXP keep_stats) {
+  while (Rglpk_cache.head)
+    Rglpk_cache_remove(Rglpk_cache.head);
+  if (asLogical(keep_stats) != TRUE)
+    Rglpk_cache.hits = Rglpk_cache.near_hits = Rglpk_cache.misses =
+      Rglpk_cache.evictions = 0.0;
+  return R_NilValue;
+}
+
+// set the budget in bytes, entries exceeding it are evicted. Returns
+// the previous budget.
+SEXP R_glp_cache_budget(SEXP budget) {
+  double old = Rglpk_cache.budget, b = asReal(budget);
+
+  if (ISNAN(b) || b < 0)
+    error("Cache budget must be a nonnegative number.");
+  Rglpk_cache.budget = b;
+  Rglpk_cache_shrink(0.0);
+  return ScalarReal(old);
+}
@@ -1,6 +1,10 @@
 #include "Rglpk.h"
 #include "setjmp.h"
 
+// problem objects created before the environment was freed must not
+// be used anymore, see Rglpk_model.c
+unsigned int Rglpk_env_generation = 0;
+
 /*
  * Path provided by Xypron
  * This hook function will be called if an error occured when
@@ -9,8 +13,32 @@
 void Rglpk_error_hook(void *in) {
   /* free glpk memory */
   glp_free_env();
+  Rglpk_env_generation++;
   /* set print hook for terminal */
   Rglpk_initialize();
   /* safely return */
   longjmp(*((jmp_buf*)in), 1);
 }
+
+/*
+ * whether GLPK keeps its environment in thread-local storage. Only
+ * then each thread has its own environment and GLPK can be used from
+ * several threads at once.
+ */
+int Rglpk_thread_safe(void) {
+#if GLP_MAJOR_VERSION > 4 || GLP_MINOR_VERSION >= 58
+  return glp_config("TLS") != NULL;
+#else
+  return 0;
+#endif
+}
+
+/*
+ * error hook used in threads other than the main thread. Each thread
+ * has its own GLPK environment, only that of the current thread is
+ * freed. In contrast to Rglpk_error_hook() the R API must not be used.
+ */
+void Rglpk_thread_error_hook(void *in) {
+  glp_free_env();
+  longjmp(*((jmp_buf*)in), 1);
+}
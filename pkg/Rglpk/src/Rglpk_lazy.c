@@ -0,0 +1,116 @@
+/* Lazy constraints (control parameter 'lazy'). Constraints too many
+ * to be stated up front (e.g., subtour elimination constraints) are
+ * generated during the branch-and-cut search: whenever the LP
+ * relaxation of a subproblem has been solved (GLP_IROWGEN) a separator
+ * is called with its solution and the violated rows it returns are
+ * added to the subproblem, which is then solved again. The separator
+ * is either an R function (wrapped by glp_lazy_separator() on the R
+ * level) or a native one, see Rglpk_separator.
+ */
+
+#include "Rglpk.h"
+#include <string.h>
+
+typedef struct {
+  glp_prob *mip;
+  int n;
+  // columns used by the row being added (zero otherwise), set if an
+  // invalid row was returned
+  int *mark;
+  int invalid;
+} Rglpk_lazy_info;
+
+int Rglpk_lazy_given(const Rglpk_control *control) {
+  return !isNull(control->lazy) || control->lazy_native;
+}
+
+// add a row to the current subproblem, see Rglpk_add_row_fn. Rows are
+// checked before being passed to GLPK, whose error hook would free the
+// whole environment: an invalid one is not added and marks the
+// separator's rows invalid, the rows following it are ignored.
+static void Rglpk_lazy_add_row(void *info, int len, const int *ind,
+                               const double *val, int dir, double rhs) {
+  Rglpk_lazy_info *lazy = (Rglpk_lazy_info *) info;
+  int i, k;
+
+  if (lazy->invalid)
+    return;
+  if (dir < 1 || dir > 5 || len < 0 || len > lazy->n || ISNAN(rhs) ||
+      !Rglpk_row_valid(dir, 0.0, rhs)) {
+    lazy->invalid = 1;
+    return;
+  }
+  for (k = 0; k < len; k++) {
+    if (ind[k] < 1 || ind[k] > lazy->n || lazy->mark[ind[k]] ||
+        !R_FINITE(val[k]))
+      break;
+    lazy->mark[ind[k]] = 1;
+  }
+  for (i = 0; i < k; i++)
+    lazy->mark[ind[i]] = 0;
+  if (k < len) {
+    lazy->invalid = 1;
+    return;
+  }
+  i = glp_add_rows(lazy->mip, 1);
+  Rglpk_set_row(lazy->mip, i, dir, 0.0, rhs);
+  // GLPK expects arrays starting at index 1
+  glp_set_mat_row(lazy->mip, i, len, ind - 1, val - 1);
+}
+
+// call the R separator with 'x' and add the rows returned (NULL if
+// none), see glp_lazy_separator() on the R level. Returns nonzero if
+// the separator failed or returned FALSE.
+static int Rglpk_lazy_call(SEXP fn, Rglpk_lazy_info *lazy, const double *x) {
+  SEXP xs, call, ret, i, j, v, dir, rhs;
+  int err = 0, k, p, q;
+
+  xs = PROTECT(allocVector(REALSXP, lazy->n));
+  memcpy(REAL(xs), x, lazy->n * sizeof(double));
+  call = PROTECT(lang2(fn, xs));
+  ret = PROTECT(R_tryEval(call, R_GlobalEnv, &err));
+  if (err || (isLogical(ret) && length(ret) == 1 &&
+              LOGICAL(ret)[0] == FALSE)) {
+    UNPROTECT(3);
+    return 1;
+  }
+  if (!isNull(ret)) {
+    // triplets ordered by row, the rows without elements included
+    i = VECTOR_ELT(ret, 0);
+    j = VECTOR_ELT(ret, 1);
+    v = VECTOR_ELT(ret, 2);
+    dir = VECTOR_ELT(ret, 3);
+    rhs = VECTOR_ELT(ret, 4);
+    for (k = 0, p = 0; k < length(rhs); k++, p = q) {
+      for (q = p; q < length(i) && INTEGER(i)[q] == k + 1; q++)
+        ;
+      Rglpk_lazy_add_row(lazy, q - p, INTEGER(j) + p, REAL(v) + p,
+                         INTEGER(dir)[k], REAL(rhs)[k]);
+    }
+  }
+  UNPROTECT(3);
+  return 0;
+}
+
+// call the separator given in 'control' with the solution of the LP
+// relaxation of the current subproblem, using 'x' (one element per
+// column) and 'mark' (one zero element per column and one more) as
+// buffers. Returns nonzero if the search is to be terminated: 1 if
+// the separator failed, 2 if it returned an invalid row.
+int Rglpk_lazy_separate(glp_tree *tree, const Rglpk_control *control,
+                        double *x, int *mark) {
+  Rglpk_lazy_info lazy;
+  int j;
+
+  lazy.mip = glp_ios_get_prob(tree);
+  lazy.n = glp_get_num_cols(lazy.mip);
+  lazy.mark = mark;
+  lazy.invalid = 0;
+  for (j = 0; j < lazy.n; j++)
+    x[j] = glp_get_col_prim(lazy.mip, j + 1);
+  if (control->lazy_native)
+    control->lazy_native(lazy.n, x, Rglpk_lazy_add_row, &lazy);
+  else if (Rglpk_lazy_call(control->lazy, &lazy, x))
+    return 1;
+  return lazy.invalid ? 2 : 0;
+}
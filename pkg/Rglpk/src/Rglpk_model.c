@@ -0,0 +1,411 @@
+/* Persistent GLPK problem objects. The problem object lives on the C
+ * level and is referenced from R via an external pointer. It can be
+ * modified in place and re-solved starting from the basis retained
+ * from the last call to the solver.
+ */
+
+#include "Rglpk.h"
+#include <setjmp.h>
+
+typedef struct {
+  glp_prob *lp;
+  // the GLPK environment the problem object was created in, see
+  // Rglpk_error_hook()
+  unsigned int generation;
+  // direction (see Rglpk_row_bounds()) and lower bound of ranged rows
+  // as given, such that the bounds can be rebuilt when the right hand
+  // side changes (GLPK's row types lose infinite right hand sides)
+  int m, size;
+  int *dir;
+  double *lhs;
+} Rglpk_model;
+
+static void Rglpk_model_finalize(SEXP ptr) {
+  Rglpk_model *model = (Rglpk_model *) R_ExternalPtrAddr(ptr);
+
+  if (!model)
+    return;
+  // if the environment has been freed in the meantime the problem
+  // object is gone already
+  if (model->lp && model->generation == Rglpk_env_generation)
+    glp_delete_prob(model->lp);
+  R_Free(model->dir);
+  R_Free(model->lhs);
+  R_Free(model);
+  R_ClearExternalPtr(ptr);
+}
+
+static Rglpk_model *Rglpk_model_data(SEXP ptr) {
+  Rglpk_model *model;
+
+  if (TYPEOF(ptr) != EXTPTRSXP)
+    error("'model' is not a GLPK problem object.");
+  model = (Rglpk_model *) R_ExternalPtrAddr(ptr);
+  if (!model || !model->lp)
+    error("GLPK problem object is not available (anymore).");
+  if (model->generation != Rglpk_env_generation)
+    error("GLPK problem object has been invalidated by an error inside the GLPK library.");
+  return model;
+}
+
+static glp_prob *Rglpk_model_get(SEXP ptr) {
+  return Rglpk_model_data(ptr)->lp;
+}
+
+// record directions and lower bounds ('lhs', zero if NULL) of 'm' rows
+// appended to the model
+static void Rglpk_model_append_rows(Rglpk_model *model, int m, const int *dir,
+                                    const double *lhs) {
+  int k;
+
+  if (model->m + m > model->size) {
+    model->size = 2 * model->size > model->m + m ? 2 * model->size :
+      model->m + m;
+    model->dir = R_Realloc(model->dir, model->size, int);
+    model->lhs = R_Realloc(model->lhs, model->size, double);
+  }
+  for (k = 0; k < m; k++) {
+    model->dir[model->m + k] = dir[k];
+    model->lhs[model->m + k] = lhs ? lhs[k] : 0.0;
+  }
+  model->m += m;
+}
+
+// wrap the problem object 'lp' into an external pointer taking care
+// of deleting it
+SEXP Rglpk_model_wrap(glp_prob *lp) {
+  Rglpk_model *model = R_Calloc(1, Rglpk_model);
+  SEXP ptr;
+
+  model->lp = lp;
+  model->generation = Rglpk_env_generation;
+  ptr = PROTECT(R_MakeExternalPtr(model, install("Rglpk_model"), R_NilValue));
+  R_RegisterCFinalizerEx(ptr, Rglpk_model_finalize, TRUE);
+  UNPROTECT(1);
+  return ptr;
+}
+
+// delete the problem object right away rather than on garbage
+// collection
+void Rglpk_model_delete(SEXP ptr) {
+  Rglpk_model_finalize(ptr);
+}
+
+// check that 'n' indices are in 1, ..., 'max'
+static void Rglpk_check_index(const int *ind, int n, int max,
+                              const char *what) {
+  int k;
+
+  for (k = 0; k < n; k++)
+    if (ind[k] == NA_INTEGER || ind[k] < 1 || ind[k] > max)
+      error("%s index %d out of range.", what, k + 1);
+}
+
+// set the constraint matrix rows (or columns if 'by_col') given as
+// triplets ordered by 'major'. Values in 'val' replace those of the
+// existing elements, zero values delete elements.
+static void Rglpk_update_mat(glp_prob *lp, int by_col, int n,
+                             const int *major, const int *minor,
+                             const double *val) {
+  int len, max, k, l, p, end;
+  int *ind, *pos;
+  double *v;
+
+  max = by_col ? glp_get_num_rows(lp) : glp_get_num_cols(lp);
+  ind = (int *) R_alloc(max + 1, sizeof(int));
+  v = (double *) R_alloc(max + 1, sizeof(double));
+  pos = (int *) R_alloc(max + 1, sizeof(int));
+  memset(pos, 0, (max + 1) * sizeof(int));
+
+  for (k = 0; k < n; k = end) {
+    len = by_col ? glp_get_mat_col(lp, major[k], ind, v)
+                 : glp_get_mat_row(lp, major[k], ind, v);
+    for (p = 1; p <= len; p++)
+      pos[ind[p]] = p;
+    for (end = k; end < n && major[end] == major[k]; end++) {
+      p = pos[minor[end]];
+      if (!p) {
+        p = pos[minor[end]] = ++len;
+        ind[p] = minor[end];
+      }
+      v[p] = val[end];
+    }
+    // remove elements which are zero now
+    for (p = 1, l = 0; p <= len; p++) {
+      pos[ind[p]] = 0;
+      if (v[p] != 0.0) {
+        l++;
+        ind[l] = ind[p];
+        v[l] = v[p];
+      }
+    }
+    if (by_col)
+      glp_set_mat_col(lp, major[k], l, ind, v);
+    else
+      glp_set_mat_row(lp, major[k], l, ind, v);
+  }
+}
+
+SEXP R_glp_model_create(SEXP x) {
+  Rglpk_data data;
+  Rglpk_model *model;
+  SEXP ptr;
+  jmp_buf env;
+
+  Rglpk_data_init(&data, x);
+  ptr = PROTECT(Rglpk_model_wrap(NULL));
+  model = (Rglpk_model *) R_ExternalPtrAddr(ptr);
+
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    model->lp = glp_create_prob();
+    Rglpk_data_load(model->lp, &data);
+  }
+  Rglpk_model_append_rows(model, data.n_rows, data.dir, data.lhs);
+  UNPROTECT(1);
+  return ptr;
+}
+
+SEXP R_glp_model_dim(SEXP ptr) {
+  glp_prob *lp = Rglpk_model_get(ptr);
+  SEXP out = PROTECT(allocVector(INTSXP, 4));
+
+  INTEGER(out)[0] = glp_get_num_rows(lp);
+  INTEGER(out)[1] = glp_get_num_cols(lp);
+  INTEGER(out)[2] = glp_get_num_nz(lp);
+  INTEGER(out)[3] = glp_get_num_int(lp);
+  UNPROTECT(1);
+  return out;
+}
+
+// change the right hand side of constraints keeping their direction,
+// the bounds are rebuilt from the direction given when the rows were
+// created (for ranged rows the upper bound is changed)
+SEXP R_glp_model_set_rhs(SEXP ptr, SEXP i, SEXP rhs) {
+  Rglpk_model *model = Rglpk_model_data(ptr);
+  glp_prob *lp = model->lp;
+  int k, n = length(i), *ind = INTEGER(i);
+  double *val = REAL(rhs);
+  jmp_buf env;
+
+  Rglpk_check_index(ind, n, glp_get_num_rows(lp), "Row");
+  for (k = 0; k < n; k++) {
+    if (ISNAN(val[k]))
+      error("Missing right hand side of row %d.", ind[k]);
+    Rglpk_row_check(ind[k], model->dir[ind[k] - 1], model->lhs[ind[k] - 1],
+                    val[k]);
+  }
+
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    for (k = 0; k < n; k++)
+      Rglpk_set_row(lp, ind[k], model->dir[ind[k] - 1],
+                    model->lhs[ind[k] - 1], val[k]);
+  }
+  return R_NilValue;
+}
+
+SEXP R_glp_model_set_obj(SEXP ptr, SEXP j, SEXP obj) {
+  glp_prob *lp = Rglpk_model_get(ptr);
+  int k, n = length(j), *ind = INTEGER(j);
+  double *val = REAL(obj);
+  jmp_buf env;
+
+  Rglpk_check_index(ind, n, glp_get_num_cols(lp), "Column");
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    for (k = 0; k < n; k++)
+      glp_set_obj_coef(lp, ind[k], val[k]);
+  }
+  return R_NilValue;
+}
+
+// change bounds of columns, the bound types are derived from the
+// bounds
+SEXP R_glp_model_set_bounds(SEXP ptr, SEXP j, SEXP lower, SEXP upper) {
+  glp_prob *lp = Rglpk_model_get(ptr);
+  int k, n = length(j), *ind = INTEGER(j);
+  jmp_buf env;
+
+  Rglpk_check_index(ind, n, glp_get_num_cols(lp), "Column");
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    for (k = 0; k < n; k++)
+      glp_set_col_bnds(lp, ind[k],
+                       Rglpk_bound_type(REAL(lower)[k], REAL(upper)[k]),
+                       REAL(lower)[k], REAL(upper)[k]);
+  }
+  return R_NilValue;
+}
+
+// change coefficients of the constraint matrix, triplets have to be
+// ordered by row
+SEXP R_glp_model_set_mat(SEXP ptr, SEXP i, SEXP j, SEXP v) {
+  glp_prob *lp = Rglpk_model_get(ptr);
+  int n = length(v);
+  jmp_buf env;
+
+  Rglpk_check_index(INTEGER(i), n, glp_get_num_rows(lp), "Row");
+  Rglpk_check_index(INTEGER(j), n, glp_get_num_cols(lp), "Column");
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    Rglpk_update_mat(lp, 0, n, INTEGER(i), INTEGER(j), REAL(v));
+  }
+  return R_NilValue;
+}
+
+// add rows, the triplets of the new part of the constraint matrix
+// have to be ordered by row and refer to the new rows 1, 2, ...
+SEXP R_glp_model_add_rows(SEXP ptr, SEXP dir, SEXP lhs, SEXP rhs, SEXP i,
+                          SEXP j, SEXP v) {
+  Rglpk_model *model = Rglpk_model_data(ptr);
+  glp_prob *lp = model->lp;
+  int k, first, m = length(dir), n = length(v);
+  int *ind;
+  jmp_buf env;
+
+  Rglpk_check_index(INTEGER(i), n, m, "Row");
+  Rglpk_check_index(INTEGER(j), n, glp_get_num_cols(lp), "Column");
+  for (k = 0; k < m; k++)
+    Rglpk_row_check(k + 1, INTEGER(dir)[k], REAL(lhs)[k], REAL(rhs)[k]);
+  if (m == 0)
+    return R_NilValue;
+  ind = (int *) R_alloc(n, sizeof(int));
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    // new rows are basic, hence a valid basis stays valid
+    first = glp_add_rows(lp, m);
+    for (k = 0; k < m; k++)
+      Rglpk_set_row(lp, first + k, INTEGER(dir)[k], REAL(lhs)[k],
+                    REAL(rhs)[k]);
+    for (k = 0; k < n; k++)
+      ind[k] = INTEGER(i)[k] + first - 1;
+    Rglpk_update_mat(lp, 0, n, ind, INTEGER(j), REAL(v));
+  }
+  Rglpk_model_append_rows(model, m, INTEGER(dir), REAL(lhs));
+  return R_NilValue;
+}
+
+// add columns, the triplets of the new part of the constraint matrix
+// have to be ordered by column and refer to the new columns 1, 2, ...
+SEXP R_glp_model_add_cols(SEXP ptr, SEXP obj, SEXP kind, SEXP bounds, SEXP i,
+                          SEXP j, SEXP v) {
+  glp_prob *lp = Rglpk_model_get(ptr);
+  int k, first, m = length(obj), n = length(v);
+  int *ind;
+  const double *lower, *upper;
+  jmp_buf env;
+
+  Rglpk_check_index(INTEGER(i), n, glp_get_num_rows(lp), "Row");
+  Rglpk_check_index(INTEGER(j), n, m, "Column");
+  if (m == 0)
+    return R_NilValue;
+  Rglpk_bounds_init(bounds, m, &lower, &upper);
+  Rglpk_cols_check(m, INTEGER(kind), length(kind), lower, upper);
+  ind = (int *) R_alloc(n, sizeof(int));
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    // new columns are non-basic, hence a valid basis stays valid
+    first = glp_add_cols(lp, m);
+    Rglpk_set_cols(lp, first, m, REAL(obj), INTEGER(kind), length(kind),
+                   lower, upper);
+    for (k = 0; k < n; k++)
+      ind[k] = INTEGER(j)[k] + first - 1;
+    Rglpk_update_mat(lp, 1, n, ind, INTEGER(i), REAL(v));
+  }
+  return R_NilValue;
+}
+
+// delete rows, indices must be unique
+SEXP R_glp_model_del_rows(SEXP ptr, SEXP i) {
+  Rglpk_model *model = Rglpk_model_data(ptr);
+  glp_prob *lp = model->lp;
+  int n = length(i), k, l;
+  jmp_buf env;
+
+  Rglpk_check_index(INTEGER(i), n, glp_get_num_rows(lp), "Row");
+  if (n == 0)
+    return R_NilValue;
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    glp_del_rows(lp, n, &INTEGER(i)[-1]);
+  }
+  // drop the directions of the deleted rows, marked by -1
+  for (k = 0; k < n; k++)
+    model->dir[INTEGER(i)[k] - 1] = -1;
+  for (k = 0, l = 0; k < model->m; k++)
+    if (model->dir[k] >= 0) {
+      model->dir[l] = model->dir[k];
+      model->lhs[l++] = model->lhs[k];
+    }
+  model->m = l;
+  return R_NilValue;
+}
+
+// delete columns, indices must be unique
+SEXP R_glp_model_del_cols(SEXP ptr, SEXP j) {
+  glp_prob *lp = Rglpk_model_get(ptr);
+  int n = length(j);
+  jmp_buf env;
+
+  Rglpk_check_index(INTEGER(j), n, glp_get_num_cols(lp), "Column");
+  if (n == 0)
+    return R_NilValue;
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    glp_del_cols(lp, n, &INTEGER(j)[-1]);
+  }
+  return R_NilValue;
+}
+
+// solve the problem starting from the basis of the last solve (if
+// still valid) and return the solution, with the reason of an early
+// termination as in R_glp_solve()
+SEXP R_glp_model_solve(SEXP ptr, SEXP control) {
+  glp_prob *lp = Rglpk_model_get(ptr);
+  Rglpk_control ctrl;
+  Rglpk_stats stats;
+  int ret, interrupted = 0;
+  SEXP out = R_NilValue;
+  jmp_buf env;
+
+  Rglpk_stats_init(&stats);
+  Rglpk_control_init(&ctrl, control);
+  ctrl.interrupted = &interrupted;
+  Rglpk_control_check(&ctrl, glp_get_num_rows(lp), glp_get_num_cols(lp));
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    glp_term_out(ctrl.verbose ? GLP_ON : GLP_OFF);
+    // the statistics are recorded for the best bound and the MIP gap
+    ret = Rglpk_run_solver(lp, &ctrl, RGLPK_WARM_DUAL, &stats, NULL);
+    out = PROTECT(Rglpk_get_solution(lp, Rglpk_solution_type(lp, &ctrl)));
+    setAttrib(out, install("termination"),
+              Rglpk_termination(lp, ret, &ctrl, &stats));
+    if (ctrl.sensitivity)
+      setAttrib(out, install("sensitivity"), Rglpk_sensitivity(lp, &ctrl));
+    UNPROTECT(1);
+  }
+  if (interrupted)
+    warning("Search interrupted, returning the best solution found so far.");
+  return out;
+}
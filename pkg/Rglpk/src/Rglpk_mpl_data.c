@@ -0,0 +1,138 @@
+/* MathProg data sections formatted from R data. GLPK's translator
+ * only reads data from files (glp_mpl_read_data()), hence sets and
+ * parameters given as R vectors are formatted as a data section
+ * directly into a raw vector, without creating R character strings or
+ * intermediate buffers, and handed to the translator via a pipe (see
+ * Rglpk_stream_open()).
+ */
+
+#include "Rglpk.h"
+#include <stdio.h>
+#include <string.h>
+
+// longest single value formatted at once (MathProg limits string
+// literals to 100 characters)
+#define RGLPK_MPL_MAX 256
+
+// output of the formatter: bytes are only counted while 'buf' is
+// NULL, hence the data section is formatted twice, once to size the
+// raw vector and once into it
+typedef struct {
+  unsigned char *buf;
+  R_xlen_t len;
+} Rglpk_mpl_buffer;
+
+static void Rglpk_mpl_write(Rglpk_mpl_buffer *b, const char *s, size_t n) {
+  if (b->buf)
+    memcpy(b->buf + b->len, s, n);
+  b->len += n;
+}
+
+static void Rglpk_mpl_puts(Rglpk_mpl_buffer *b, const char *s) {
+  Rglpk_mpl_write(b, s, strlen(s));
+}
+
+// value 'k' of column 'x', numbers as such and strings as quoted
+// literals
+static void Rglpk_mpl_value(Rglpk_mpl_buffer *b, SEXP x, R_xlen_t k) {
+  char tmp[RGLPK_MPL_MAX + 4], *p = tmp;
+  const char *s;
+  int n;
+
+  *p++ = ' ';
+  if (TYPEOF(x) == REALSXP) {
+    n = snprintf(p, RGLPK_MPL_MAX, "%.17g", REAL(x)[k]);
+    Rglpk_mpl_write(b, tmp, n + 1);
+    return;
+  }
+  s = CHAR(STRING_ELT(x, k));
+  *p++ = '\'';
+  for (n = 2; *s && n < RGLPK_MPL_MAX; s++) {
+    if (*s == '\'') {
+      *p++ = '\'';
+      n++;
+    }
+    *p++ = *s;
+    n++;
+  }
+  *p = '\'';
+  Rglpk_mpl_write(b, tmp, n + 1);
+}
+
+// set 'name' with tuples given by the columns 'cols'
+static void Rglpk_mpl_set(Rglpk_mpl_buffer *b, const char *name, SEXP cols) {
+  int d = length(cols), i;
+  R_xlen_t n = d > 0 ? XLENGTH(VECTOR_ELT(cols, 0)) : 0, k;
+
+  Rglpk_mpl_puts(b, "set ");
+  Rglpk_mpl_puts(b, name);
+  Rglpk_mpl_puts(b, " :=\n");
+  for (k = 0; k < n; k++) {
+    if (d > 1)
+      Rglpk_mpl_puts(b, " (");
+    for (i = 0; i < d; i++) {
+      if (i > 0)
+        Rglpk_mpl_puts(b, ",");
+      Rglpk_mpl_value(b, VECTOR_ELT(cols, i), k);
+    }
+    Rglpk_mpl_puts(b, d > 1 ? ")\n" : "\n");
+  }
+  Rglpk_mpl_puts(b, ";\n");
+}
+
+// parameter 'name' given by index columns followed by the column of
+// values. Missing values are left out (i.e., take the default).
+static void Rglpk_mpl_param(Rglpk_mpl_buffer *b, const char *name,
+                            SEXP cols) {
+  int d = length(cols) - 1, i;
+  SEXP val = VECTOR_ELT(cols, d);
+  R_xlen_t n = XLENGTH(val), k;
+
+  Rglpk_mpl_puts(b, "param ");
+  Rglpk_mpl_puts(b, name);
+  Rglpk_mpl_puts(b, " :=");
+  for (k = 0; k < n; k++) {
+    if (TYPEOF(val) == REALSXP ? ISNAN(REAL(val)[k]) :
+        STRING_ELT(val, k) == NA_STRING)
+      continue;
+    if (d > 0)
+      Rglpk_mpl_puts(b, "\n");
+    for (i = 0; i <= d; i++)
+      Rglpk_mpl_value(b, VECTOR_ELT(cols, i), k);
+  }
+  Rglpk_mpl_puts(b, "\n;\n");
+}
+
+// format the data section of the entries in 'data' into 'b'
+static void Rglpk_mpl_format(Rglpk_mpl_buffer *b, SEXP data) {
+  SEXP entry;
+  int k;
+
+  Rglpk_mpl_puts(b, "data;\n");
+  for (k = 0; k < length(data); k++) {
+    entry = VECTOR_ELT(data, k);
+    if (asLogical(VECTOR_ELT(entry, 1)) == TRUE)
+      Rglpk_mpl_param(b, CHAR(asChar(VECTOR_ELT(entry, 0))),
+                      VECTOR_ELT(entry, 2));
+    else
+      Rglpk_mpl_set(b, CHAR(asChar(VECTOR_ELT(entry, 0))),
+                    VECTOR_ELT(entry, 2));
+  }
+  Rglpk_mpl_puts(b, "end;\n");
+}
+
+// format the data section of the entries in 'data' (as prepared by
+// glp_mpl_data() on the R level) into a raw vector of exactly its
+// length, the only copy of the text held
+SEXP R_glp_mpl_data(SEXP data) {
+  Rglpk_mpl_buffer b = {NULL, 0};
+  SEXP out;
+
+  Rglpk_mpl_format(&b, data);
+  out = PROTECT(allocVector(RAWSXP, b.len));
+  b.buf = RAW(out);
+  b.len = 0;
+  Rglpk_mpl_format(&b, data);
+  UNPROTECT(1);
+  return out;
+}
@@ -0,0 +1,1160 @@
+/* A native reader for files in fixed and free MPS format. The file is
+ * memory-mapped, the COLUMNS section (which holds the bulk of the data)
+ * is tokenized in line aligned chunks in parallel and the problem data
+ * is written straight into the list also returned by
+ * Rglpk_retrieve_MP(), no GLPK problem object is built in between.
+ *
+ * The semantics of glp_read_mps() are followed: the first row of type
+ * N is the objective function and is kept as free row, integer columns
+ * (between INTORG and INTEND markers) are binary by default, and
+ * values smaller than 1e-12 in magnitude are replaced by zero. Input
+ * which is not handled in exactly the same way (e.g., embedded blanks
+ * in names, sections unknown to GLPK, or malformed cards) is left to
+ * glp_read_mps(), which then also reports possible errors.
+ */
+
+#include "Rglpk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// the default tolerance of glp_read_mps(), see glp_init_mpscp()
+#define RGLPK_MPS_TOL 1e-12
+// minimum size of the chunks processed in parallel
+#define RGLPK_MPS_CHUNK (1 << 20)
+
+// status codes: the file is left to glp_read_mps() if it cannot be
+// read natively
+#define RGLPK_MPS_OK 0
+#define RGLPK_MPS_GLPK 1
+#define RGLPK_MPS_NOMEM 3
+
+// sections in the order required
+enum {RGLPK_MPS_NAME, RGLPK_MPS_ROWS, RGLPK_MPS_COLUMNS, RGLPK_MPS_RHS,
+      RGLPK_MPS_RANGES, RGLPK_MPS_BOUNDS, RGLPK_MPS_ENDATA,
+      RGLPK_MPS_SECTIONS};
+
+static const char *Rglpk_mps_sections[] = {"NAME", "ROWS", "COLUMNS", "RHS",
+                                           "RANGES", "BOUNDS", "ENDATA"};
+
+// field positions (first and last column) of the fixed MPS format
+static const int Rglpk_mps_fields[6][2] = {{2, 3}, {5, 12}, {15, 22},
+                                           {25, 36}, {40, 47}, {50, 61}};
+
+// a string inside the file, not terminated
+typedef struct {
+  const char *ptr;
+  int len;
+} Rglpk_token;
+
+// the six fields of a data card, empty fields have length zero
+typedef struct {
+  Rglpk_token f[6];
+} Rglpk_card;
+
+// open addressing hash table of the (1-based) names 'names'
+typedef struct {
+  unsigned int mask;
+  int *slot;
+  const Rglpk_token *names;
+} Rglpk_hash;
+
+// indicator cards found in a chunk of the file
+#define RGLPK_MPS_MAX_HEADERS 8
+typedef struct {
+  const char *beg, *end;
+  int n;
+  const char *header[RGLPK_MPS_MAX_HEADERS];
+} Rglpk_mps_scan;
+
+// data of the COLUMNS section read from a chunk of lines. Columns
+// are stored as segments of consecutive cards, the first segment may
+// continue the last column of the preceding chunk (its name is empty
+// if it starts with a blank column name). The integer marker
+// in effect at the start of the chunk is not known, 'seg_kind' is -1
+// for segments before the first marker of the chunk, 'kind_end' is the
+// marker in effect at the end of the chunk (-1 if there is none).
+typedef struct {
+  const char *beg, *end;
+  int status;
+  int n_seg, max_seg, kind_end;
+  Rglpk_token *seg_name;
+  int *seg_kind, *seg_start;
+  int nnz, max_nnz, offset;
+  int *row;
+  double *val;
+} Rglpk_mps_chunk;
+
+typedef struct {
+  int status, deck;
+  char *buf;
+  size_t size;
+  // the buffer is either mapped, owned, or borrowed from R
+  int mapped, borrowed;
+  const char *section[RGLPK_MPS_SECTIONS + 1];
+  Rglpk_token name;
+  // rows with GLPK's row types and bounds
+  int m, max_m, obj_row;
+  Rglpk_token *row_name;
+  int *row_type;
+  double *row_lb, *row_ub;
+  Rglpk_hash rows, cols;
+  int n_chunks;
+  Rglpk_mps_chunk *chunks;
+  // columns and the constraint matrix in compressed column form
+  int n, nnz;
+  Rglpk_token *col_name;
+  int *col_kind, *col_ptr, *mat_row;
+  double *obj, *col_lb, *col_ub, *mat_val;
+} Rglpk_mps;
+
+static int Rglpk_token_eq(const Rglpk_token *a, const Rglpk_token *b) {
+  return a->len == b->len && !memcmp(a->ptr, b->ptr, a->len);
+}
+
+static int Rglpk_token_is(const Rglpk_token *a, const char *str) {
+  return a->len == (int) strlen(str) && !memcmp(a->ptr, str, a->len);
+}
+
+// FNV-1a
+static unsigned int Rglpk_hash_value(const Rglpk_token *t) {
+  unsigned int h = 2166136261u;
+  int k;
+
+  for (k = 0; k < t->len; k++)
+    h = (h ^ (unsigned char) t->ptr[k]) * 16777619u;
+  return h;
+}
+
+// table for 'n' names, returns non-zero if running out of memory
+static int Rglpk_hash_init(Rglpk_hash *hash, const Rglpk_token *names, int n) {
+  unsigned int size = 16;
+
+  while (size < 2u * (unsigned int) n)
+    size <<= 1;
+  hash->mask = size - 1;
+  hash->names = names;
+  hash->slot = (int *) calloc(size, sizeof(int));
+  return hash->slot == NULL;
+}
+
+// index of name 't', zero if not found
+static int Rglpk_hash_find(const Rglpk_hash *hash, const Rglpk_token *t) {
+  unsigned int h = Rglpk_hash_value(t) & hash->mask;
+
+  while (hash->slot[h]) {
+    if (Rglpk_token_eq(&hash->names[hash->slot[h]], t))
+      return hash->slot[h];
+    h = (h + 1) & hash->mask;
+  }
+  return 0;
+}
+
+// add name 'k', returns non-zero if the name is already present
+static int Rglpk_hash_insert(Rglpk_hash *hash, int k) {
+  unsigned int h = Rglpk_hash_value(&hash->names[k]) & hash->mask;
+
+  while (hash->slot[h]) {
+    if (Rglpk_token_eq(&hash->names[hash->slot[h]], &hash->names[k]))
+      return 1;
+    h = (h + 1) & hash->mask;
+  }
+  hash->slot[h] = k;
+  return 0;
+}
+
+// advance '*p' past the next line which is returned in [*beg, *eol)
+// without the line terminator. Returns zero at the end of the range.
+static int Rglpk_mps_line(const char **p, const char *end, const char **beg,
+                          const char **eol) {
+  const char *q;
+
+  if (*p >= end)
+    return 0;
+  *beg = *p;
+  q = (const char *) memchr(*p, '\n', end - *p);
+  if (!q)
+    q = end;
+  *p = q < end ? q + 1 : end;
+  if (q > *beg && q[-1] == '\r')
+    q--;
+  *eol = q;
+  return 1;
+}
+
+// comment cards and blank cards are skipped
+static int Rglpk_mps_skip(const char *beg, const char *eol) {
+  if (beg < eol && *beg == '*')
+    return 1;
+  for (; beg < eol; beg++)
+    if (*beg != ' ' && *beg != '\t')
+      return 0;
+  return 1;
+}
+
+// indicator cards start in the first column
+static int Rglpk_mps_is_header(const char *beg, const char *eol) {
+  return beg < eol && *beg != ' ' && *beg != '\t' && *beg != '*';
+}
+
+static void Rglpk_token_trim(Rglpk_token *t) {
+  while (t->len && (*t->ptr == ' ' || *t->ptr == '\t'))
+    t->ptr++, t->len--;
+  while (t->len && (t->ptr[t->len - 1] == ' ' || t->ptr[t->len - 1] == '\t'))
+    t->len--;
+}
+
+// split a data card of the fixed MPS format into its fields. Returns
+// non-zero if the card is left to GLPK.
+static int Rglpk_mps_card_fixed(const char *beg, const char *eol,
+                                Rglpk_card *card) {
+  int len = eol - beg, pos = 0, k, a, b, l;
+
+  memset(card, 0, sizeof(Rglpk_card));
+  for (k = 0; k < 6; k++) {
+    a = Rglpk_mps_fields[k][0] - 1;
+    b = Rglpk_mps_fields[k][1];
+    // the positions between the fields must be blank
+    for (; pos < a && pos < len; pos++)
+      if (beg[pos] != ' ')
+        return 1;
+    if (a >= len)
+      return 0;
+    // a comment may begin in field 3 or 5
+    if ((k == 2 || k == 4) && beg[a] == '$')
+      return 0;
+    card->f[k].ptr = beg + a;
+    card->f[k].len = (b < len ? b : len) - a;
+    Rglpk_token_trim(&card->f[k]);
+    // glp_read_mps() removes embedded blanks
+    for (l = 0; l < card->f[k].len; l++)
+      if (card->f[k].ptr[l] == ' ' || card->f[k].ptr[l] == '\t')
+        return 1;
+    pos = b;
+  }
+  for (; pos < len; pos++)
+    if (beg[pos] != ' ')
+      return 1;
+  return 0;
+}
+
+// split a data card of the free MPS format into its fields according
+// to section 'section'. Vector names in the RHS, RANGES, and BOUNDS
+// sections may be omitted. Returns non-zero if the card is left to
+// GLPK.
+static int Rglpk_mps_card_free(const char *beg, const char *eol, int section,
+                               Rglpk_card *card) {
+  Rglpk_token t[7];
+  int n = 0, k, value;
+
+  memset(card, 0, sizeof(Rglpk_card));
+  while (beg < eol) {
+    while (beg < eol && (*beg == ' ' || *beg == '\t'))
+      beg++;
+    if (beg == eol)
+      break;
+    // a comment may begin in field 3 or 5
+    if (n >= 2 && *beg == '$')
+      break;
+    if (n == 7)
+      return 1;
+    t[n].ptr = beg;
+    while (beg < eol && *beg != ' ' && *beg != '\t')
+      beg++;
+    t[n].len = beg - t[n].ptr;
+    n++;
+  }
+
+  switch (section) {
+  case RGLPK_MPS_ROWS:
+    if (n != 2)
+      return 1;
+    card->f[0] = t[0];
+    card->f[1] = t[1];
+    break;
+  case RGLPK_MPS_COLUMNS:
+    if (n == 3 && Rglpk_token_is(&t[1], "'MARKER'")) {
+      card->f[1] = t[0];
+      card->f[2] = t[1];
+      card->f[4] = t[2];
+      break;
+    }
+    if (n != 3 && n != 5)
+      return 1;
+    for (k = 0; k < n; k++)
+      card->f[k + 1] = t[k];
+    break;
+  case RGLPK_MPS_RHS:
+  case RGLPK_MPS_RANGES:
+    if (n < 2 || n > 5)
+      return 1;
+    for (k = 0; k < n; k++)
+      card->f[k + 1 + (n % 2 == 0)] = t[k];
+    break;
+  case RGLPK_MPS_BOUNDS:
+    if (n < 2)
+      return 1;
+    card->f[0] = t[0];
+    value = !(Rglpk_token_is(&t[0], "FR") || Rglpk_token_is(&t[0], "MI") ||
+              Rglpk_token_is(&t[0], "PL") || Rglpk_token_is(&t[0], "BV"));
+    if (n == 3 + value) {
+      card->f[1] = t[1];
+      card->f[2] = t[2];
+      if (value)
+        card->f[3] = t[3];
+    } else if (n == 2 + value) {
+      card->f[2] = t[1];
+      if (value)
+        card->f[3] = t[2];
+    } else
+      return 1;
+    break;
+  default:
+    return 1;
+  }
+  return 0;
+}
+
+static int Rglpk_mps_card(const Rglpk_mps *mps, const char *beg,
+                          const char *eol, int section, Rglpk_card *card) {
+  return mps->deck ? Rglpk_mps_card_fixed(beg, eol, card)
+                   : Rglpk_mps_card_free(beg, eol, section, card);
+}
+
+// numeric value of field 't'. Returns non-zero if this is not a number
+// accepted by GLPK.
+static int Rglpk_mps_number(const Rglpk_token *t, double *x) {
+  char buf[64], *end;
+  int k;
+
+  if (t->len == 0 || t->len >= (int) sizeof(buf))
+    return 1;
+  for (k = 0; k < t->len; k++) {
+    buf[k] = t->ptr[k];
+    if (!((buf[k] >= '0' && buf[k] <= '9') || buf[k] == '.' || buf[k] == 'e' ||
+          buf[k] == 'E' || buf[k] == '+' || buf[k] == '-'))
+      return 1;
+  }
+  buf[k] = '\0';
+  *x = strtod(buf, &end);
+  if (*end != '\0' || !isfinite(*x))
+    return 1;
+  if (fabs(*x) < RGLPK_MPS_TOL)
+    *x = 0.0;
+  return 0;
+}
+
+// GLPK limits names to 255 characters
+static int Rglpk_mps_bad_name(const Rglpk_token *t) {
+  return t->len == 0 || t->len > 255;
+}
+
+// find the indicator cards in a chunk of the file
+static void Rglpk_mps_scan_chunk(Rglpk_mps_scan *scan) {
+  const char *p = scan->beg, *beg, *eol;
+
+  scan->n = 0;
+  while (Rglpk_mps_line(&p, scan->end, &beg, &eol)) {
+    if (!Rglpk_mps_is_header(beg, eol))
+      continue;
+    // more than all sections, the file is left to GLPK anyway
+    if (scan->n == RGLPK_MPS_MAX_HEADERS)
+      return;
+    scan->header[scan->n++] = beg;
+  }
+}
+
+// split [beg, end) into 'n' chunks starting at the beginning of a line
+static void Rglpk_mps_split(const char *beg, const char *end, int n,
+                            const char **bounds) {
+  const char *p;
+  int k;
+
+  bounds[0] = beg;
+  for (k = 1; k < n; k++) {
+    p = beg + (size_t) (end - beg) / n * k;
+    if (p < bounds[k - 1])
+      p = bounds[k - 1];
+    p = (const char *) memchr(p, '\n', end - p);
+    bounds[k] = p ? p + 1 : end;
+  }
+  bounds[n] = end;
+}
+
+static int Rglpk_mps_n_chunks(size_t size, int nthreads) {
+  size_t n = size / RGLPK_MPS_CHUNK + 1;
+
+  // a few chunks per thread balance the load
+  return n < 4 * (size_t) nthreads ? (int) n : 4 * nthreads;
+}
+
+// locate the sections of the file, sets mps->section[k] to the
+// beginning of the indicator card of section 'k' (NULL if missing)
+static void Rglpk_mps_sections_find(Rglpk_mps *mps, int nthreads) {
+  int n = Rglpk_mps_n_chunks(mps->size, nthreads), k, l, s, len, next;
+  const char **bounds, *eol;
+  Rglpk_mps_scan *scan;
+
+  bounds = (const char **) malloc((n + 1) * sizeof(char *));
+  scan = (Rglpk_mps_scan *) malloc(n * sizeof(Rglpk_mps_scan));
+  if (!bounds || !scan) {
+    free(bounds);
+    free(scan);
+    mps->status = RGLPK_MPS_NOMEM;
+    return;
+  }
+  Rglpk_mps_split(mps->buf, mps->buf + mps->size, n, bounds);
+  for (k = 0; k < n; k++) {
+    scan[k].beg = bounds[k];
+    scan[k].end = bounds[k + 1];
+  }
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+#endif
+  for (k = 0; k < n; k++)
+    Rglpk_mps_scan_chunk(&scan[k]);
+
+  // the sections must appear in the order given, RHS, RANGES, and
+  // BOUNDS are optional
+  next = RGLPK_MPS_NAME;
+  for (k = 0; k < n && next <= RGLPK_MPS_ENDATA; k++) {
+    if (scan[k].n == RGLPK_MPS_MAX_HEADERS) {
+      mps->status = RGLPK_MPS_GLPK;
+      break;
+    }
+    for (l = 0; l < scan[k].n && next <= RGLPK_MPS_ENDATA; l++) {
+      eol = (const char *) memchr(scan[k].header[l], '\n',
+                                  mps->buf + mps->size - scan[k].header[l]);
+      len = (eol ? eol : mps->buf + mps->size) - scan[k].header[l];
+      for (s = next; s <= RGLPK_MPS_ENDATA; s++) {
+        int sl = strlen(Rglpk_mps_sections[s]);
+        if (len >= sl && !memcmp(scan[k].header[l], Rglpk_mps_sections[s], sl)
+            && (len == sl || scan[k].header[l][sl] == ' ' ||
+                scan[k].header[l][sl] == '\r'))
+          break;
+      }
+      // NAME, ROWS, and COLUMNS must not be skipped
+      if (s > RGLPK_MPS_ENDATA || (s > next && next <= RGLPK_MPS_COLUMNS)) {
+        mps->status = RGLPK_MPS_GLPK;
+        break;
+      }
+      mps->section[s] = scan[k].header[l];
+      next = s + 1;
+    }
+    if (mps->status != RGLPK_MPS_OK)
+      break;
+  }
+  if (next <= RGLPK_MPS_ENDATA)
+    mps->status = RGLPK_MPS_GLPK;
+  free(bounds);
+  free(scan);
+}
+
+// data range of section 's', from the card following its indicator
+// card to the next section
+static void Rglpk_mps_range(const Rglpk_mps *mps, int s, const char **beg,
+                            const char **end) {
+  const char *eol;
+  int k;
+
+  eol = (const char *) memchr(mps->section[s], '\n',
+                              mps->buf + mps->size - mps->section[s]);
+  *beg = eol ? eol + 1 : mps->buf + mps->size;
+  for (k = s + 1; !mps->section[k]; k++)
+    ;
+  *end = mps->section[k];
+}
+
+// problem name given on the NAME card
+static void Rglpk_mps_name(Rglpk_mps *mps) {
+  const char *p = mps->section[RGLPK_MPS_NAME], *beg, *eol;
+  const char *end = mps->buf + mps->size;
+  int k;
+
+  Rglpk_mps_line(&p, end, &beg, &eol);
+  mps->name.ptr = beg + 4;
+  mps->name.len = eol - beg - 4;
+  Rglpk_token_trim(&mps->name);
+  for (k = 0; k < mps->name.len; k++)
+    if (mps->name.ptr[k] == ' ' || mps->name.ptr[k] == '\t')
+      mps->status = RGLPK_MPS_GLPK;
+}
+
+static void Rglpk_mps_rows(Rglpk_mps *mps) {
+  const char *p, *end, *beg, *eol;
+  Rglpk_card card;
+  int type, i;
+  void *tmp;
+
+  Rglpk_mps_range(mps, RGLPK_MPS_ROWS, &p, &end);
+  while (Rglpk_mps_line(&p, end, &beg, &eol)) {
+    if (Rglpk_mps_skip(beg, eol))
+      continue;
+    if (Rglpk_mps_card(mps, beg, eol, RGLPK_MPS_ROWS, &card) ||
+        card.f[0].len != 1 || Rglpk_mps_bad_name(&card.f[1]) ||
+        card.f[2].len || card.f[3].len || card.f[4].len || card.f[5].len) {
+      mps->status = RGLPK_MPS_GLPK;
+      return;
+    }
+    switch (card.f[0].ptr[0]) {
+    case 'N': type = GLP_FR; break;
+    case 'G': type = GLP_LO; break;
+    case 'L': type = GLP_UP; break;
+    case 'E': type = GLP_FX; break;
+    default:
+      mps->status = RGLPK_MPS_GLPK;
+      return;
+    }
+    // rows are stored 1-based
+    if (mps->m + 1 >= mps->max_m) {
+      mps->max_m = 2 * mps->max_m + 64;
+      if (!(tmp = realloc(mps->row_name, mps->max_m * sizeof(Rglpk_token))))
+        goto nomem;
+      mps->row_name = (Rglpk_token *) tmp;
+      if (!(tmp = realloc(mps->row_type, mps->max_m * sizeof(int))))
+        goto nomem;
+      mps->row_type = (int *) tmp;
+    }
+    i = ++mps->m;
+    mps->row_name[i] = card.f[1];
+    mps->row_type[i] = type;
+    // the first row of type N is the objective function
+    if (type == GLP_FR && !mps->obj_row)
+      mps->obj_row = i;
+  }
+
+  mps->row_lb = (double *) calloc(mps->m + 1, sizeof(double));
+  mps->row_ub = (double *) calloc(mps->m + 1, sizeof(double));
+  if (!mps->row_lb || !mps->row_ub ||
+      Rglpk_hash_init(&mps->rows, mps->row_name, mps->m))
+    goto nomem;
+  for (i = 1; i <= mps->m; i++)
+    if (Rglpk_hash_insert(&mps->rows, i)) {
+      mps->status = RGLPK_MPS_GLPK;
+      return;
+    }
+  return;
+
+ nomem:
+  mps->status = RGLPK_MPS_NOMEM;
+}
+
+static int Rglpk_mps_chunk_grow(Rglpk_mps_chunk *ch, int seg) {
+  void *tmp;
+
+  if (seg) {
+    ch->max_seg = 2 * ch->max_seg + 64;
+    if (!(tmp = realloc(ch->seg_name, ch->max_seg * sizeof(Rglpk_token))))
+      return 1;
+    ch->seg_name = (Rglpk_token *) tmp;
+    if (!(tmp = realloc(ch->seg_kind, ch->max_seg * sizeof(int))))
+      return 1;
+    ch->seg_kind = (int *) tmp;
+    if (!(tmp = realloc(ch->seg_start, ch->max_seg * sizeof(int))))
+      return 1;
+    ch->seg_start = (int *) tmp;
+    return 0;
+  }
+  ch->max_nnz = 2 * ch->max_nnz + 256;
+  if (!(tmp = realloc(ch->row, ch->max_nnz * sizeof(int))))
+    return 1;
+  ch->row = (int *) tmp;
+  if (!(tmp = realloc(ch->val, ch->max_nnz * sizeof(double))))
+    return 1;
+  ch->val = (double *) tmp;
+  return 0;
+}
+
+// tokenize the COLUMNS cards of a chunk. This runs in parallel, hence
+// neither the R API nor R's memory allocation must be used.
+static void Rglpk_mps_columns_chunk(const Rglpk_mps *mps,
+                                    Rglpk_mps_chunk *ch) {
+  const char *p = ch->beg, *beg, *eol;
+  Rglpk_card card;
+  int kind = -1, f, i;
+  double v;
+
+  ch->kind_end = -1;
+  while (Rglpk_mps_line(&p, ch->end, &beg, &eol)) {
+    if (Rglpk_mps_skip(beg, eol))
+      continue;
+    if (Rglpk_mps_card(mps, beg, eol, RGLPK_MPS_COLUMNS, &card) ||
+        card.f[0].len || card.f[1].len > 255)
+      goto glpk;
+    if (Rglpk_token_is(&card.f[2], "'MARKER'")) {
+      if (Rglpk_token_is(&card.f[4], "'INTORG'"))
+        kind = GLP_IV;
+      else if (Rglpk_token_is(&card.f[4], "'INTEND'"))
+        kind = GLP_CV;
+      else
+        goto glpk;
+      ch->kind_end = kind;
+      continue;
+    }
+    // a new column begins, a blank name continues the current column
+    // (which may begin in the preceding chunk)
+    if (!ch->n_seg || (card.f[1].len &&
+                       !Rglpk_token_eq(&ch->seg_name[ch->n_seg - 1], &card.f[1]))) {
+      if (ch->n_seg == ch->max_seg && Rglpk_mps_chunk_grow(ch, 1))
+        goto nomem;
+      ch->seg_name[ch->n_seg] = card.f[1];
+      ch->seg_kind[ch->n_seg] = kind;
+      ch->seg_start[ch->n_seg] = ch->nnz;
+      ch->n_seg++;
+    }
+    // fields 3 and 4, 5 and 6 hold row names and coefficients
+    for (f = 2; f <= 4; f += 2) {
+      if (!card.f[f].len) {
+        if (f == 2 || card.f[f + 1].len)
+          goto glpk;
+        break;
+      }
+      i = Rglpk_hash_find(&mps->rows, &card.f[f]);
+      if (!i || Rglpk_mps_number(&card.f[f + 1], &v))
+        goto glpk;
+      if (ch->nnz == ch->max_nnz && Rglpk_mps_chunk_grow(ch, 0))
+        goto nomem;
+      ch->row[ch->nnz] = i;
+      ch->val[ch->nnz] = v;
+      ch->nnz++;
+    }
+  }
+  ch->status = RGLPK_MPS_OK;
+  return;
+
+ glpk:
+  ch->status = RGLPK_MPS_GLPK;
+  return;
+ nomem:
+  ch->status = RGLPK_MPS_NOMEM;
+}
+
+// read the COLUMNS section in parallel and assemble the constraint
+// matrix in compressed column form
+static void Rglpk_mps_columns(Rglpk_mps *mps, int nthreads) {
+  const char *beg, *end, **bounds;
+  Rglpk_mps_chunk *ch;
+  int n, k, s, j, kind, n_seg, *stamp;
+  double nnz;
+
+  Rglpk_mps_range(mps, RGLPK_MPS_COLUMNS, &beg, &end);
+  n = Rglpk_mps_n_chunks(end - beg, nthreads);
+  mps->chunks = (Rglpk_mps_chunk *) calloc(n, sizeof(Rglpk_mps_chunk));
+  bounds = (const char **) malloc((n + 1) * sizeof(char *));
+  if (!mps->chunks || !bounds) {
+    free(bounds);
+    mps->status = RGLPK_MPS_NOMEM;
+    return;
+  }
+  mps->n_chunks = n;
+  Rglpk_mps_split(beg, end, n, bounds);
+  for (k = 0; k < n; k++) {
+    mps->chunks[k].beg = bounds[k];
+    mps->chunks[k].end = bounds[k + 1];
+  }
+  free(bounds);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+#endif
+  for (k = 0; k < n; k++)
+    Rglpk_mps_columns_chunk(mps, &mps->chunks[k]);
+
+  n_seg = 0;
+  nnz = 0;
+  for (k = 0; k < n; k++) {
+    ch = &mps->chunks[k];
+    if (ch->status != RGLPK_MPS_OK) {
+      mps->status = ch->status;
+      return;
+    }
+    ch->offset = (int) nnz;
+    n_seg += ch->n_seg;
+    nnz += ch->nnz;
+  }
+  if (nnz > INT_MAX) {
+    mps->status = RGLPK_MPS_GLPK;
+    return;
+  }
+  mps->nnz = (int) nnz;
+
+  // columns are stored 1-based
+  mps->col_name = (Rglpk_token *) malloc((n_seg + 1) * sizeof(Rglpk_token));
+  mps->col_kind = (int *) malloc((n_seg + 1) * sizeof(int));
+  mps->col_ptr = (int *) malloc((n_seg + 2) * sizeof(int));
+  mps->mat_row = (int *) malloc((mps->nnz + 1) * sizeof(int));
+  mps->mat_val = (double *) malloc((mps->nnz + 1) * sizeof(double));
+  if (!mps->col_name || !mps->col_kind || !mps->col_ptr || !mps->mat_row ||
+      !mps->mat_val) {
+    mps->status = RGLPK_MPS_NOMEM;
+    return;
+  }
+
+  // segments continuing the column of the preceding chunk are merged,
+  // the integer markers are resolved in file order
+  kind = GLP_CV;
+  j = 0;
+  for (k = 0; k < n; k++) {
+    ch = &mps->chunks[k];
+    for (s = 0; s < ch->n_seg; s++) {
+      if (s == 0 && j && (!ch->seg_name[0].len ||
+                          Rglpk_token_eq(&mps->col_name[j], &ch->seg_name[0])))
+        continue;
+      if (!ch->seg_name[s].len) {
+        mps->status = RGLPK_MPS_GLPK;
+        return;
+      }
+      j++;
+      mps->col_name[j] = ch->seg_name[s];
+      mps->col_kind[j] = ch->seg_kind[s] < 0 ? kind : ch->seg_kind[s];
+      mps->col_ptr[j] = ch->offset + ch->seg_start[s];
+    }
+    if (ch->kind_end >= 0)
+      kind = ch->kind_end;
+  }
+  mps->n = j;
+  mps->col_ptr[j + 1] = mps->nnz;
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+#endif
+  for (k = 0; k < n; k++) {
+    memcpy(&mps->mat_row[mps->chunks[k].offset], mps->chunks[k].row,
+           mps->chunks[k].nnz * sizeof(int));
+    memcpy(&mps->mat_val[mps->chunks[k].offset], mps->chunks[k].val,
+           mps->chunks[k].nnz * sizeof(double));
+  }
+
+  // column names must be unique, each row may appear only once per
+  // column
+  stamp = (int *) calloc(mps->m + 1, sizeof(int));
+  if (!stamp || Rglpk_hash_init(&mps->cols, mps->col_name, mps->n)) {
+    free(stamp);
+    mps->status = RGLPK_MPS_NOMEM;
+    return;
+  }
+  for (j = 1; j <= mps->n && mps->status == RGLPK_MPS_OK; j++) {
+    if (Rglpk_hash_insert(&mps->cols, j))
+      mps->status = RGLPK_MPS_GLPK;
+    for (k = mps->col_ptr[j]; k < mps->col_ptr[j + 1]; k++) {
+      if (stamp[mps->mat_row[k]] == j)
+        mps->status = RGLPK_MPS_GLPK;
+      stamp[mps->mat_row[k]] = j;
+    }
+  }
+  free(stamp);
+}
+
+// free the chunks once the COLUMNS section has been assembled
+static void Rglpk_mps_chunks_free(Rglpk_mps *mps) {
+  int k;
+
+  for (k = 0; k < mps->n_chunks; k++) {
+    free(mps->chunks[k].seg_name);
+    free(mps->chunks[k].seg_kind);
+    free(mps->chunks[k].seg_start);
+    free(mps->chunks[k].row);
+    free(mps->chunks[k].val);
+  }
+  free(mps->chunks);
+  mps->chunks = NULL;
+  mps->n_chunks = 0;
+}
+
+// default bounds and objective coefficients of the columns
+static void Rglpk_mps_cols(Rglpk_mps *mps) {
+  int j, k;
+
+  mps->obj = (double *) calloc(mps->n + 1, sizeof(double));
+  mps->col_lb = (double *) calloc(mps->n + 1, sizeof(double));
+  mps->col_ub = (double *) calloc(mps->n + 1, sizeof(double));
+  if (!mps->obj || !mps->col_lb || !mps->col_ub) {
+    mps->status = RGLPK_MPS_NOMEM;
+    return;
+  }
+  for (j = 1; j <= mps->n; j++) {
+    // integer columns are binary unless bounds are given
+    mps->col_ub[j] = mps->col_kind[j] == GLP_IV ? 1.0 : HUGE_VAL;
+    if (!mps->obj_row)
+      continue;
+    for (k = mps->col_ptr[j]; k < mps->col_ptr[j + 1]; k++)
+      if (mps->mat_row[k] == mps->obj_row)
+        mps->obj[j] = mps->mat_val[k];
+  }
+}
+
+// the cards of the RHS and RANGES sections. Only a single vector is
+// supported, vector names may be left blank after the first card.
+static void Rglpk_mps_rhs(Rglpk_mps *mps, int section) {
+  const char *p, *end, *beg, *eol;
+  Rglpk_token vector = {NULL, 0};
+  Rglpk_card card;
+  char *seen;
+  int f, i, type;
+  double v, lb, ub;
+
+  if (!mps->section[section])
+    return;
+  if (!(seen = (char *) calloc(mps->m + 1, 1))) {
+    mps->status = RGLPK_MPS_NOMEM;
+    return;
+  }
+  Rglpk_mps_range(mps, section, &p, &end);
+  while (Rglpk_mps_line(&p, end, &beg, &eol)) {
+    if (Rglpk_mps_skip(beg, eol))
+      continue;
+    if (Rglpk_mps_card(mps, beg, eol, section, &card) || card.f[0].len)
+      goto glpk;
+    if (card.f[1].len) {
+      if (!vector.len)
+        vector = card.f[1];
+      else if (!Rglpk_token_eq(&vector, &card.f[1]))
+        goto glpk;
+    }
+    for (f = 2; f <= 4; f += 2) {
+      if (!card.f[f].len) {
+        if (f == 2 || card.f[f + 1].len)
+          goto glpk;
+        break;
+      }
+      i = Rglpk_hash_find(&mps->rows, &card.f[f]);
+      if (!i || seen[i] || Rglpk_mps_number(&card.f[f + 1], &v))
+        goto glpk;
+      seen[i] = 1;
+      type = mps->row_type[i];
+      if (section == RGLPK_MPS_RHS) {
+        // the right hand side of free rows (including the constant
+        // term of the objective) is not retrieved
+        if (type != GLP_FR)
+          mps->row_lb[i] = mps->row_ub[i] = v;
+        continue;
+      }
+      lb = mps->row_lb[i];
+      ub = mps->row_ub[i];
+      switch (type) {
+      case GLP_LO:
+        ub = lb + fabs(v);
+        break;
+      case GLP_UP:
+        lb = ub - fabs(v);
+        break;
+      case GLP_FX:
+        if (v > 0.0)
+          ub = lb + v;
+        else
+          lb = ub + v;
+        break;
+      default:
+        goto glpk;
+      }
+      mps->row_lb[i] = lb;
+      mps->row_ub[i] = ub;
+      mps->row_type[i] = lb == ub ? GLP_FX : GLP_DB;
+    }
+  }
+  free(seen);
+  return;
+
+ glpk:
+  free(seen);
+  mps->status = RGLPK_MPS_GLPK;
+}
+
+static void Rglpk_mps_bounds(Rglpk_mps *mps) {
+  const char *p, *end, *beg, *eol;
+  Rglpk_token vector = {NULL, 0};
+  Rglpk_card card;
+  int j;
+  double v = 0.0;
+
+  if (!mps->section[RGLPK_MPS_BOUNDS])
+    return;
+  Rglpk_mps_range(mps, RGLPK_MPS_BOUNDS, &p, &end);
+  while (Rglpk_mps_line(&p, end, &beg, &eol)) {
+    if (Rglpk_mps_skip(beg, eol))
+      continue;
+    if (Rglpk_mps_card(mps, beg, eol, RGLPK_MPS_BOUNDS, &card) ||
+        card.f[0].len != 2 || card.f[4].len || card.f[5].len)
+      goto glpk;
+    if (card.f[1].len) {
+      if (!vector.len)
+        vector = card.f[1];
+      else if (!Rglpk_token_eq(&vector, &card.f[1]))
+        goto glpk;
+    }
+    if (!(j = Rglpk_hash_find(&mps->cols, &card.f[2])))
+      goto glpk;
+    if (card.f[3].len && Rglpk_mps_number(&card.f[3], &v))
+      goto glpk;
+    if (Rglpk_token_is(&card.f[0], "UP")) {
+      // glp_read_mps() might treat negative upper bounds specially
+      if (!card.f[3].len || (v < 0.0 && mps->col_lb[j] == 0.0))
+        goto glpk;
+      mps->col_ub[j] = v;
+    } else if (Rglpk_token_is(&card.f[0], "LO")) {
+      if (!card.f[3].len)
+        goto glpk;
+      mps->col_lb[j] = v;
+    } else if (Rglpk_token_is(&card.f[0], "FX")) {
+      if (!card.f[3].len)
+        goto glpk;
+      mps->col_lb[j] = mps->col_ub[j] = v;
+    } else if (Rglpk_token_is(&card.f[0], "FR")) {
+      mps->col_lb[j] = -HUGE_VAL;
+      mps->col_ub[j] = HUGE_VAL;
+    } else if (Rglpk_token_is(&card.f[0], "MI")) {
+      mps->col_lb[j] = -HUGE_VAL;
+    } else if (Rglpk_token_is(&card.f[0], "PL")) {
+      mps->col_ub[j] = HUGE_VAL;
+    } else if (Rglpk_token_is(&card.f[0], "BV")) {
+      mps->col_kind[j] = GLP_IV;
+      mps->col_lb[j] = 0.0;
+      mps->col_ub[j] = 1.0;
+    } else
+      goto glpk;
+  }
+  return;
+
+ glpk:
+  mps->status = RGLPK_MPS_GLPK;
+}
+
+static int Rglpk_mps_map(Rglpk_mps *mps, const char *file) {
+#ifdef _WIN32
+  FILE *fp = fopen(file, "rb");
+  long size;
+
+  if (!fp)
+    return 1;
+  if (fseek(fp, 0, SEEK_END) || (size = ftell(fp)) <= 0 ||
+      fseek(fp, 0, SEEK_SET)) {
+    fclose(fp);
+    return 1;
+  }
+  mps->buf = (char *) malloc(size);
+  if (!mps->buf || fread(mps->buf, 1, size, fp) != (size_t) size) {
+    fclose(fp);
+    return 1;
+  }
+  fclose(fp);
+  mps->size = size;
+#else
+  struct stat st;
+  void *buf;
+  int fd = open(file, O_RDONLY);
+
+  if (fd < 0)
+    return 1;
+  if (fstat(fd, &st) || st.st_size <= 0) {
+    close(fd);
+    return 1;
+  }
+  buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (buf == MAP_FAILED)
+    return 1;
+  mps->buf = (char *) buf;
+  mps->size = st.st_size;
+  mps->mapped = 1;
+#endif
+  return 0;
+}
+
+static void Rglpk_mps_finalize(SEXP ptr) {
+  Rglpk_mps *mps = (Rglpk_mps *) R_ExternalPtrAddr(ptr);
+
+  if (!mps)
+    return;
+  Rglpk_mps_chunks_free(mps);
+#ifndef _WIN32
+  if (mps->mapped)
+    munmap(mps->buf, mps->size);
+  else
+#endif
+  if (!mps->borrowed)
+    free(mps->buf);
+  free(mps->row_name);
+  free(mps->row_type);
+  free(mps->row_lb);
+  free(mps->row_ub);
+  free(mps->rows.slot);
+  free(mps->cols.slot);
+  free(mps->col_name);
+  free(mps->col_kind);
+  free(mps->col_ptr);
+  free(mps->mat_row);
+  free(mps->mat_val);
+  free(mps->obj);
+  free(mps->col_lb);
+  free(mps->col_ub);
+  R_Free(mps);
+  R_ClearExternalPtr(ptr);
+}
+
+// parse the file mapped into 'mps' using up to 'nthreads' threads
+static void Rglpk_mps_parse(Rglpk_mps *mps, int nthreads) {
+  Rglpk_mps_sections_find(mps, nthreads);
+  if (mps->status == RGLPK_MPS_OK)
+    Rglpk_mps_name(mps);
+  if (mps->status == RGLPK_MPS_OK)
+    Rglpk_mps_rows(mps);
+  if (mps->status == RGLPK_MPS_OK)
+    Rglpk_mps_columns(mps, nthreads);
+  Rglpk_mps_chunks_free(mps);
+  if (mps->status == RGLPK_MPS_OK)
+    Rglpk_mps_cols(mps);
+  if (mps->status == RGLPK_MPS_OK)
+    Rglpk_mps_rhs(mps, RGLPK_MPS_RHS);
+  if (mps->status == RGLPK_MPS_OK)
+    Rglpk_mps_rhs(mps, RGLPK_MPS_RANGES);
+  if (mps->status == RGLPK_MPS_OK)
+    Rglpk_mps_bounds(mps);
+}
+
+static SEXP Rglpk_token_string(const Rglpk_token *t) {
+  return t->len ? mkCharLen(t->ptr, t->len) : R_BlankString;
+}
+
+// the problem data in the form returned by Rglpk_retrieve_MP(). The
+// constraint matrix is stored row by row, the columns of a row in
+// decreasing order (as retrieved from a GLPK problem object).
+static SEXP Rglpk_mps_list(const Rglpk_mps *mps, int first, int names) {
+  Rglpk_MP mp, data;
+  int i, j, k, l, bin, *pos;
+  double v;
+  SEXP out, str;
+
+  memset(&mp, 0, sizeof(Rglpk_MP));
+  mp.m = mps->m - first + 1;
+  mp.n = mps->n;
+  pos = (int *) R_alloc(mps->m + 2, sizeof(int));
+  memset(pos, 0, (mps->m + 2) * sizeof(int));
+  for (k = 0; k < mps->nnz; k++)
+    if (mps->mat_row[k] >= first && mps->mat_val[k] != 0.0)
+      pos[mps->mat_row[k] + 1]++;
+  for (i = first; i <= mps->m; i++)
+    pos[i + 1] += pos[i];
+  mp.nnz = pos[mps->m + 1];
+  for (j = 1; j <= mps->n; j++)
+    if (mps->col_kind[j] == GLP_IV) {
+      mp.n_int++;
+      mp.n_bin += mps->col_lb[j] == 0.0 && mps->col_ub[j] == 1.0;
+    }
+
+  out = PROTECT(Rglpk_MP_list(&mp, &data));
+  SET_VECTOR_ELT(out, 1, ScalarString(Rglpk_token_string(&mps->name)));
+  if (mps->obj_row)
+    SET_VECTOR_ELT(out, 2, ScalarString(Rglpk_token_string(&mps->row_name[mps->obj_row])));
+
+  for (j = 1; j <= mps->n; j++) {
+    bin = mps->col_kind[j] == GLP_IV && mps->col_lb[j] == 0.0 &&
+      mps->col_ub[j] == 1.0;
+    data.obj[j - 1] = mps->obj[j];
+    data.lower[j - 1] = mps->col_lb[j];
+    data.upper[j - 1] = mps->col_ub[j];
+    data.is_int[j - 1] = mps->col_kind[j] == GLP_IV && !bin;
+    data.is_bin[j - 1] = bin;
+  }
+  for (i = first; i <= mps->m; i++) {
+    l = i - first;
+    data.dir[l] = mps->row_type[i];
+    data.rhs[l] = data.lhs[l] = 0.0;
+    switch (mps->row_type[i]) {
+    case GLP_LO:
+    case GLP_FX:
+      data.rhs[l] = mps->row_lb[i];
+      break;
+    case GLP_UP:
+      data.rhs[l] = mps->row_ub[i];
+      break;
+    case GLP_DB:
+      data.rhs[l] = mps->row_ub[i];
+      data.lhs[l] = mps->row_lb[i];
+      break;
+    }
+  }
+  // counting sort of the elements by row, zero elements are dropped
+  for (j = mps->n; j >= 1; j--)
+    for (k = mps->col_ptr[j]; k < mps->col_ptr[j + 1]; k++) {
+      i = mps->mat_row[k];
+      v = mps->mat_val[k];
+      if (i < first || v == 0.0)
+        continue;
+      l = pos[i]++;
+      data.mat_i[l] = i - first + 1;
+      data.mat_j[l] = j;
+      data.mat_v[l] = v;
+    }
+
+  if (names) {
+    str = allocVector(STRSXP, mp.m);
+    SET_VECTOR_ELT(out, 19, str);
+    for (i = first; i <= mps->m; i++)
+      SET_STRING_ELT(str, i - first, Rglpk_token_string(&mps->row_name[i]));
+    str = allocVector(STRSXP, mp.n);
+    SET_VECTOR_ELT(out, 20, str);
+    for (j = 1; j <= mps->n; j++)
+      SET_STRING_ELT(str, j - 1, Rglpk_token_string(&mps->col_name[j]));
+  }
+  UNPROTECT(1);
+  return out;
+}
+
+// read a LP/MILP from a file in MPS format ('type' 1 for fixed, 2 for
+// free format) without GLPK. 'file' is either a file name or a raw
+// vector holding the contents of the file. Returns the data as
+// R_glp_read_file() or NULL if the file has to be read by GLPK.
+SEXP R_glp_read_mps(SEXP file, SEXP type, SEXP ignore_first_row, SEXP names,
+                    SEXP verbose) {
+  const char *fname = TYPEOF(file) == RAWSXP ? "<raw>"
+                                             : CHAR(STRING_ELT(file, 0));
+  int nthreads = 1, first;
+  Rglpk_mps *mps;
+  SEXP out, ptr;
+
+  mps = R_Calloc(1, Rglpk_mps);
+  ptr = PROTECT(R_MakeExternalPtr(mps, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, Rglpk_mps_finalize, TRUE);
+  mps->deck = asInteger(type) == 1;
+
+#ifdef _OPENMP
+  nthreads = omp_get_max_threads();
+#endif
+  if (asLogical(verbose) == TRUE)
+    Rprintf("Reading file %s using %d thread(s) ...\n", fname, nthreads);
+  if (TYPEOF(file) == RAWSXP) {
+    mps->buf = (char *) RAW(file);
+    mps->size = XLENGTH(file);
+    mps->borrowed = 1;
+  }
+  if (mps->borrowed ? !mps->size : Rglpk_mps_map(mps, fname))
+    mps->status = RGLPK_MPS_GLPK;
+  else
+    Rglpk_mps_parse(mps, nthreads);
+
+  if (mps->status == RGLPK_MPS_NOMEM) {
+    Rglpk_mps_finalize(ptr);
+    error("Not enough memory to read file %s", fname);
+  }
+  if (mps->status != RGLPK_MPS_OK) {
+    Rglpk_mps_finalize(ptr);
+    UNPROTECT(1);
+    return R_NilValue;
+  }
+  first = asLogical(ignore_first_row) == TRUE && mps->m > 0 ? 2 : 1;
+  out = Rglpk_mps_list(mps, first, asLogical(names) == TRUE);
+  Rglpk_mps_finalize(ptr);
+  UNPROTECT(1);
+  return out;
+}
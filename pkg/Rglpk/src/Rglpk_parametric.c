@@ -0,0 +1,140 @@
+/* Parametric solves: the same problem is solved for a sequence of
+ * right hand sides and/or objective coefficients. A single problem
+ * object is kept for the whole sequence and each point is solved
+ * starting from the basis of the previous one, with the dual simplex
+ * if right hand sides change (the basis stays dual feasible) and the
+ * primal simplex if only the objective changes (the basis stays primal
+ * feasible).
+ */
+
+#include "Rglpk.h"
+#include <setjmp.h>
+#include <string.h>
+
+// solve the problem 'x' (as prepared by glp_prepare_MP()) for each
+// column of 'rhs' (right hand sides of rows 'rows') and 'obj'
+// (objective coefficients of columns 'cols'), either of which may be
+// NULL. 'outputs' flags the solution parts returned as matrices with
+// one column per point: solution, solution_dual, row_primal, row_dual.
+SEXP R_glp_solve_parametric(SEXP x, SEXP control, SEXP rows, SEXP rhs,
+                            SEXP cols, SEXP obj, SEXP outputs) {
+  static const char *names[] = {"status", "optimum", "solution",
+                                "solution_dual", "row_primal", "row_dual",
+                                ""};
+  glp_prob *lp;
+  Rglpk_data data;
+  Rglpk_control ctrl;
+  Rglpk_solution sol;
+  int n_rows = length(rows), n_cols = length(cols), *row_ind, *col_ind;
+  int m, n, k, p, n_points, type, warm, interrupted = 0, expired = 0;
+  double *x_scratch, *x_dual_scratch, *row_scratch, *row_dual_scratch;
+  SEXP out;
+  jmp_buf env;
+
+  Rglpk_control_init(&ctrl, control);
+  ctrl.interrupted = &interrupted;
+  Rglpk_data_init(&data, x);
+  Rglpk_control_check(&ctrl, data.n_rows, data.n_cols);
+  m = data.n_rows;
+  n = data.n_cols;
+  row_ind = INTEGER(rows);
+  col_ind = INTEGER(cols);
+  for (k = 0; k < n_rows; k++)
+    if (row_ind[k] == NA_INTEGER || row_ind[k] < 1 || row_ind[k] > m)
+      error("Row index %d out of range.", k + 1);
+  for (k = 0; k < n_cols; k++)
+    if (col_ind[k] == NA_INTEGER || col_ind[k] < 1 || col_ind[k] > n)
+      error("Column index %d out of range.", k + 1);
+  n_points = !isNull(rhs) ? ncols(rhs) : ncols(obj);
+  if ((!isNull(rhs) && nrows(rhs) != n_rows) ||
+      (!isNull(obj) && (nrows(obj) != n_cols || ncols(obj) != n_points)))
+    error("Parameter values do not conform to the rows and columns varied.");
+  // right hand sides are checked like those of the base problem
+  for (p = 0; p < n_points; p++)
+    for (k = 0; k < n_rows; k++)
+      Rglpk_row_check(row_ind[k], data.dir[row_ind[k] - 1], 0.0,
+                      REAL(rhs)[(R_xlen_t) p * n_rows + k]);
+
+  out = PROTECT(mkNamed(VECSXP, names));
+  SET_VECTOR_ELT(out, 0, allocVector(INTSXP, n_points));
+  SET_VECTOR_ELT(out, 1, allocVector(REALSXP, n_points));
+  for (k = 0; k < 4; k++)
+    if (LOGICAL(outputs)[k])
+      SET_VECTOR_ELT(out, k + 2, allocMatrix(REALSXP, k < 2 ? n : m,
+                                             n_points));
+  // points not solved (after an interrupt or once the time limit has
+  // been reached) are NA
+  for (p = 0; p < n_points; p++) {
+    INTEGER(VECTOR_ELT(out, 0))[p] = NA_INTEGER;
+    REAL(VECTOR_ELT(out, 1))[p] = NA_REAL;
+  }
+  for (k = 2; k < 6; k++)
+    if (!isNull(VECTOR_ELT(out, k)))
+      for (p = 0; p < XLENGTH(VECTOR_ELT(out, k)); p++)
+        REAL(VECTOR_ELT(out, k))[p] = NA_REAL;
+  // parts of the solution not returned are extracted into these
+  x_scratch = (double *) R_alloc(n + 1, sizeof(double));
+  x_dual_scratch = (double *) R_alloc(n + 1, sizeof(double));
+  row_scratch = (double *) R_alloc(m + 1, sizeof(double));
+  row_dual_scratch = (double *) R_alloc(m + 1, sizeof(double));
+  memset(&sol, 0, sizeof(Rglpk_solution));
+  sol.m = m;
+  sol.n = n;
+  sol.col_stat = (int *) R_alloc(n + 1, sizeof(int));
+  sol.row_stat = (int *) R_alloc(m + 1, sizeof(int));
+
+  if (setjmp(env)) {
+    error("An error occured inside the GLPK library.");
+  } else {
+    glp_error_hook(Rglpk_error_hook, &env);
+    glp_term_out(ctrl.verbose ? GLP_ON : GLP_OFF);
+
+    lp = glp_create_prob();
+    Rglpk_data_load(lp, &data);
+    sol.type = type = Rglpk_solution_type(lp, &ctrl);
+    // with only the objective changing the basis stays primal feasible
+    warm = isNull(rhs) ? RGLPK_WARM_PRIMAL : RGLPK_WARM_DUAL;
+
+    // the time limit applies to the whole sweep. The bounds of the
+    // rows varied are rebuilt from their direction at each point, as
+    // infinite right hand sides make rows free (ranged rows are
+    // rejected on the R level).
+    for (p = 0; p < n_points && !interrupted && !expired; p++) {
+      for (k = 0; k < n_rows; k++)
+        Rglpk_set_row(lp, row_ind[k], data.dir[row_ind[k] - 1], 0.0,
+                      REAL(rhs)[(R_xlen_t) p * n_rows + k]);
+      for (k = 0; k < n_cols; k++)
+        glp_set_obj_coef(lp, col_ind[k],
+                         REAL(obj)[(R_xlen_t) p * n_cols + k]);
+      Rglpk_run_solver(lp, &ctrl, p > 0 ? warm : 0, NULL, NULL);
+      // a starting basis only applies to the first point, the later
+      // ones start from the basis of the previous point
+      ctrl.col_stat = ctrl.row_stat = NULL;
+      ctrl.n_col_stat = ctrl.n_row_stat = 0;
+
+      sol.x = LOGICAL(outputs)[0] ?
+        REAL(VECTOR_ELT(out, 2)) + (R_xlen_t) p * n : x_scratch;
+      sol.x_dual = LOGICAL(outputs)[1] && type != GLP_MIP ?
+        REAL(VECTOR_ELT(out, 3)) + (R_xlen_t) p * n : x_dual_scratch;
+      sol.row = LOGICAL(outputs)[2] ?
+        REAL(VECTOR_ELT(out, 4)) + (R_xlen_t) p * m : row_scratch;
+      sol.row_dual = LOGICAL(outputs)[3] && type != GLP_MIP ?
+        REAL(VECTOR_ELT(out, 5)) + (R_xlen_t) p * m : row_dual_scratch;
+      Rglpk_solution_extract(lp, &sol);
+      INTEGER(VECTOR_ELT(out, 0))[p] = sol.status;
+      REAL(VECTOR_ELT(out, 1))[p] = sol.optimum;
+      expired = ctrl.deadline > 0 && Rglpk_wall_time() >= ctrl.deadline;
+      // the simplex method cannot be interrupted, hence LP sweeps are
+      // checked between points
+      if (!interrupted && p + 1 < n_points && Rglpk_user_interrupt())
+        interrupted = 1;
+    }
+    glp_delete_prob(lp);
+  }
+  if (interrupted)
+    warning("Sweep interrupted, remaining points not solved.");
+  else if (expired && p < n_points)
+    warning("Time limit reached, remaining points not solved.");
+  UNPROTECT(1);
+  return out;
+}
@@ -0,0 +1,574 @@
+/* Conversion of problem data and control parameters passed down from
+ * R via .Call() into plain C structures, and loading of such data
+ * into a GLPK problem object.
+ */
+
+#include "Rglpk.h"
+
+// get list element by name, R_NilValue if not found
+SEXP Rglpk_get_elt(SEXP list, const char *name) {
+  SEXP names = getAttrib(list, R_NamesSymbol);
+  int i;
+
+  if (isNull(names))
+    return R_NilValue;
+  for (i = 0; i < length(list); i++)
+    if (strcmp(CHAR(STRING_ELT(names, i)), name) == 0)
+      return VECTOR_ELT(list, i);
+  return R_NilValue;
+}
+
+static SEXP Rglpk_get_sized_elt(SEXP list, const char *name, int n) {
+  SEXP x = Rglpk_get_elt(list, name);
+
+  if (n >= 0 && length(x) != n)
+    error("Element '%s' of problem data must be of length %d.", name, n);
+  return x;
+}
+
+// integer vector of problem data. Integer vectors are used in place,
+// double vectors are converted. We do not check for NAs here, indices
+// and codes are range checked afterwards anyway.
+static const int *Rglpk_int_elt(SEXP list, const char *name, int n) {
+  SEXP x = Rglpk_get_sized_elt(list, name, n);
+  int k, *out;
+  double v;
+
+  switch (TYPEOF(x)) {
+  case INTSXP:
+  case LGLSXP:
+    return INTEGER(x);
+  case REALSXP:
+    out = (int *) R_alloc(length(x), sizeof(int));
+    for (k = 0; k < length(x); k++) {
+      v = REAL(x)[k];
+      out[k] = (ISNAN(v) || v < -INT_MAX || v > INT_MAX) ? NA_INTEGER : (int) v;
+    }
+    return out;
+  default:
+    error("Element '%s' of problem data must be numeric.", name);
+  }
+  return NULL;
+}
+
+// double vector of problem data. Double vectors are used in place,
+// integer vectors are converted. Missing values are not allowed.
+static const double *Rglpk_real_elt(SEXP list, const char *name, int n) {
+  SEXP x = Rglpk_get_sized_elt(list, name, n);
+  int k;
+  double *out;
+
+  switch (TYPEOF(x)) {
+  case REALSXP:
+    out = REAL(x);
+    for (k = 0; k < length(x); k++)
+      if (ISNAN(out[k]))
+        error("Element '%s' of problem data must not contain missing values.",
+              name);
+    return out;
+  case INTSXP:
+  case LGLSXP:
+    out = (double *) R_alloc(length(x), sizeof(double));
+    for (k = 0; k < length(x); k++) {
+      if (INTEGER(x)[k] == NA_INTEGER)
+        error("Element '%s' of problem data must not contain missing values.",
+              name);
+      out[k] = INTEGER(x)[k];
+    }
+    return out;
+  default:
+    error("Element '%s' of problem data must be numeric.", name);
+  }
+  return NULL;
+}
+
+// objective coefficients given as sparse vector (elements 'obj_ind'
+// and 'obj_val'), expanded to a dense vector of length 'n'
+static const double *Rglpk_sparse_obj(SEXP x, int n) {
+  int len = length(Rglpk_get_elt(x, "obj_val")), k;
+  const int *ind = Rglpk_int_elt(x, "obj_ind", len);
+  const double *val = Rglpk_real_elt(x, "obj_val", len);
+  double *out = (double *) R_alloc(n, sizeof(double));
+
+  memset(out, 0, n * sizeof(double));
+  for (k = 0; k < len; k++) {
+    if (ind[k] == NA_INTEGER || ind[k] < 1 || ind[k] > n)
+      error("Index of objective coefficient %d out of range.", k + 1);
+    out[ind[k] - 1] = val[k];
+  }
+  return out;
+}
+
+// sparse bounds given by elements 'ind_name' and 'val_name' of 'x'
+// scattered into a vector of length 'n' holding 'def' otherwise. NULL
+// if there are none (all bounds take the default). 'mark' (of length
+// 'n') is used for detecting duplicated indices.
+static const double *Rglpk_sparse_bounds(SEXP x, const char *ind_name,
+                                         const char *val_name, int n,
+                                         double def, char *mark) {
+  int len = length(Rglpk_get_elt(x, val_name)), j, k;
+  const int *ind = Rglpk_int_elt(x, ind_name, len);
+  const double *val = Rglpk_real_elt(x, val_name, len);
+  double *out;
+
+  if (len == 0)
+    return NULL;
+  out = (double *) R_alloc(n, sizeof(double));
+  for (j = 0; j < n; j++)
+    out[j] = def;
+  memset(mark, 0, n);
+  for (k = 0; k < len; k++) {
+    j = ind[k];
+    if (j == NA_INTEGER || j < 1 || j > n)
+      error("Bound indices must not exceed number of objective coefficients.");
+    if (mark[j - 1])
+      error("Duplicated entries in bound indices found.");
+    mark[j - 1] = 1;
+    out[j - 1] = val[k];
+  }
+  return out;
+}
+
+// bounds of the objective variables given as sparse lower and upper
+// bounds (elements 'bounds_lower_ind', 'bounds_lower_val',
+// 'bounds_upper_ind', 'bounds_upper_val' of 'x'). Variables default to
+// 0 <= x <= Inf, *lower and *upper are set to NULL if all variables
+// take the default.
+void Rglpk_bounds_init(SEXP x, int n, const double **lower,
+                       const double **upper) {
+  char *mark = (char *) R_alloc(n > 0 ? n : 1, sizeof(char));
+  int j;
+
+  *lower = Rglpk_sparse_bounds(x, "bounds_lower_ind", "bounds_lower_val", n,
+                               0.0, mark);
+  *upper = Rglpk_sparse_bounds(x, "bounds_upper_ind", "bounds_upper_val", n,
+                               R_PosInf, mark);
+  for (j = 0; *lower && j < n; j++)
+    if ((*lower)[j] == R_PosInf)
+      error("Lower bound cannot be 'Inf'");
+  for (j = 0; *upper && j < n; j++)
+    if ((*upper)[j] == R_NegInf)
+      error("Upper bound cannot be '-Inf'");
+}
+
+// check types (recycled, see Rglpk_set_cols()) and bounds of 'n'
+// objective variables
+void Rglpk_cols_check(int n, const int *kind, int n_kind,
+                      const double *lower, const double *upper) {
+  int j, k;
+  double lb, ub;
+
+  if (n > 0 && n_kind == 0)
+    error("Invalid type of objective variable 1.");
+  for (j = 0; j < n; j++) {
+    k = kind[j % n_kind];
+    if (k < GLP_CV || k > GLP_BV)
+      error("Invalid type of objective variable %d.", j + 1);
+    lb = lower ? lower[j] : 0.0;
+    ub = upper ? upper[j] : R_PosInf;
+    if (lb > ub)
+      error("Upper bounds have to be greater than or equal to lower bounds");
+    if (k == GLP_BV && lb == ub && lb != 0.0 && lb != 1.0)
+      error("binary variables can only be fixed to 0L or 1L");
+  }
+}
+
+// constraint matrix of problem data. GLPK stops with a library error
+// on out of range or duplicated indices. We rather check beforehand: a
+// library error resets the GLPK environment and thus invalidates all
+// problem objects alive.
+static void Rglpk_matrix_init(Rglpk_data *data, SEXP x) {
+  SEXP dense = Rglpk_get_elt(x, "mat_dense");
+  int m = data->n_rows, n = data->n_cols, j, k;
+  const int *p, *i;
+
+  if (!isNull(dense)) {
+    data->mat_format = RGLPK_MAT_DENSE;
+    if (XLENGTH(dense) != (R_xlen_t) m * n)
+      error("Element 'mat_dense' of problem data must be of length %.0f.",
+            (double) m * n);
+    data->mat_v = Rglpk_real_elt(x, "mat_dense", -1);
+    data->n_nz = 0;
+    return;
+  }
+
+  data->n_nz = length(Rglpk_get_elt(x, "mat_v"));
+  data->mat_v = Rglpk_real_elt(x, "mat_v", data->n_nz);
+  if (!isNull(Rglpk_get_elt(x, "mat_p"))) {
+    // compressed sparse columns as stored in a 'dgCMatrix'
+    data->mat_format = RGLPK_MAT_CSC;
+    data->mat_p = p = Rglpk_int_elt(x, "mat_p", n + 1);
+    data->mat_i = i = Rglpk_int_elt(x, "mat_i", data->n_nz);
+    if (p[0] != 0 || p[n] != data->n_nz)
+      error("Invalid column pointers of constraint matrix.");
+    for (j = 0; j < n; j++) {
+      if (p[j + 1] < p[j])
+        error("Invalid column pointers of constraint matrix.");
+      for (k = p[j]; k < p[j + 1]; k++) {
+        if (i[k] == NA_INTEGER || i[k] < 0 || i[k] >= m)
+          error("Index of constraint matrix element %d out of range.", k + 1);
+        if (k > p[j] && i[k] <= i[k - 1])
+          error("Duplicated or unsorted entry %d in constraint matrix.", k + 1);
+      }
+    }
+    return;
+  }
+
+  data->mat_format = RGLPK_MAT_TRIPLET;
+  data->mat_i = Rglpk_int_elt(x, "mat_i", data->n_nz);
+  data->mat_j = Rglpk_int_elt(x, "mat_j", data->n_nz);
+  if (data->n_nz > 0) {
+    k = glp_check_dup(m, n, data->n_nz, &data->mat_i[-1], &data->mat_j[-1]);
+    if (k < 0)
+      error("Index of constraint matrix element %d out of range.", -k);
+    if (k > 0)
+      error("Duplicated entry %d in constraint matrix.", k);
+  }
+}
+
+// fill 'data' with pointers into the vectors of the R list 'x' (as
+// prepared by glp_prepare_MP() on the R level). Vectors of the right
+// type are not copied, hence 'x' must be protected as long as 'data'
+// is in use.
+void Rglpk_data_init(Rglpk_data *data, SEXP x) {
+  int k;
+
+  data->maximize = asLogical(Rglpk_get_elt(x, "max")) == TRUE;
+  data->n_rows = asInteger(Rglpk_get_elt(x, "n_rows"));
+  data->n_cols = asInteger(Rglpk_get_elt(x, "n_cols"));
+  if (data->n_rows == NA_INTEGER || data->n_rows < 0 ||
+      data->n_cols == NA_INTEGER || data->n_cols < 0)
+    error("Invalid problem dimensions.");
+
+  data->obj = isNull(Rglpk_get_elt(x, "obj_ind")) ?
+    Rglpk_real_elt(x, "obj", data->n_cols) : Rglpk_sparse_obj(x, data->n_cols);
+  data->n_kind = length(Rglpk_get_elt(x, "kind"));
+  data->kind = Rglpk_int_elt(x, "kind", data->n_kind);
+  Rglpk_bounds_init(x, data->n_cols, &data->bounds_lower,
+                    &data->bounds_upper);
+  data->dir = Rglpk_int_elt(x, "dir", data->n_rows);
+  data->rhs = Rglpk_real_elt(x, "rhs", data->n_rows);
+  data->lhs = isNull(Rglpk_get_elt(x, "lhs")) ? NULL :
+    Rglpk_real_elt(x, "lhs", data->n_rows);
+
+  Rglpk_matrix_init(data, x);
+
+  Rglpk_cols_check(data->n_cols, data->kind, data->n_kind, data->bounds_lower,
+                   data->bounds_upper);
+  for (k = 0; k < data->n_rows; k++) {
+    if (data->dir[k] < (data->lhs ? 0 : 1) || data->dir[k] > 5)
+      error("Invalid direction of constraint %d.", k + 1);
+    Rglpk_row_check(k + 1, data->dir[k], data->lhs ? data->lhs[k] : 0.0,
+                    data->rhs[k]);
+  }
+}
+
+// GLPK bound type of 'lb' <= . <= 'ub', infinite bounds are dropped
+int Rglpk_bound_type(double lb, double ub) {
+  if (lb == ub)
+    return GLP_FX;
+  if (lb == R_NegInf)
+    return ub == R_PosInf ? GLP_FR : GLP_UP;
+  return ub == R_PosInf ? GLP_LO : GLP_DB;
+}
+
+// bounds of a row according to Rglpk's coding of the direction of
+// constraints: 0 ranged ('lhs' <= . <= 'rhs'), 1 '<', 2 '<=', 3 '>',
+// 4 '>=', 5 '=='. Returns the GLPK row type: ranged rows with infinite
+// bounds become GLP_LO, GLP_UP or GLP_FR rows (and one-sided ones with
+// infinite right hand side GLP_FR rows). The bounds have to be checked
+// by Rglpk_row_check() beforehand.
+int Rglpk_row_bounds(int dir, double lhs, double rhs, double *lb, double *ub) {
+  *lb = R_NegInf;
+  *ub = R_PosInf;
+  switch (dir) {
+  case 0:
+    *lb = lhs;
+    *ub = rhs;
+    break;
+  case 1:
+  case 2:
+    *ub = rhs;
+    break;
+  case 3:
+  case 4:
+    *lb = rhs;
+    break;
+  case 5:
+    *lb = *ub = rhs;
+    break;
+  }
+  return Rglpk_bound_type(*lb, *ub);
+}
+
+// check the bounds of constraint 'k' (1-based, used in messages), see
+// Rglpk_row_bounds(). An infinite right hand side may only drop a
+// bound ('<=' Inf and '>=' -Inf make the row free): rows such as
+// '==' Inf cannot be satisfied and GLPK rejects fixed bounds at
+// infinity.
+void Rglpk_row_check(int k, int dir, double lhs, double rhs) {
+  if (dir == 0 && lhs > rhs)
+    error("Invalid range of constraint %d.", k);
+  if (!Rglpk_row_valid(dir, lhs, rhs))
+    error("Infinite right hand side of constraint %d cannot be satisfied.", k);
+}
+
+// whether the bounds of a row are valid, see Rglpk_row_check(). Used
+// where no R error may be raised.
+int Rglpk_row_valid(int dir, double lhs, double rhs) {
+  double lb, ub;
+
+  Rglpk_row_bounds(dir, lhs, rhs, &lb, &ub);
+  return lb <= ub && lb != R_PosInf && ub != R_NegInf;
+}
+
+// set bounds of row 'i' (1-based), see Rglpk_row_bounds()
+void Rglpk_set_row(glp_prob *lp, int i, int dir, double lhs, double rhs) {
+  double lb, ub;
+  int type = Rglpk_row_bounds(dir, lhs, rhs, &lb, &ub);
+
+  // unused bounds are ignored by GLPK
+  glp_set_row_bnds(lp, i, type, lb, ub);
+}
+
+// add columns 'first', ..., 'first' + n - 1 (1-based) in one pass.
+// Types 'kind' are recycled, NULL bounds take the defaults 0 and Inf
+// (see Rglpk_bounds_init()). GLPK does not fix binary variables
+// (setting the kind resets the bounds to 0 and 1), hence fixed binary
+// variables are made integer.
+void Rglpk_set_cols(glp_prob *lp, int first, int n, const double *obj,
+                    const int *kind, int n_kind, const double *bounds_lower,
+                    const double *bounds_upper) {
+  int j, k;
+  double lb, ub;
+
+  for (j = 0; j < n; j++) {
+    lb = bounds_lower ? bounds_lower[j] : 0.0;
+    ub = bounds_upper ? bounds_upper[j] : R_PosInf;
+    k = kind[j % n_kind];
+    if (k == GLP_BV && lb == ub)
+      k = GLP_IV;
+    glp_set_col_bnds(lp, first + j, Rglpk_bound_type(lb, ub), lb, ub);
+    glp_set_obj_coef(lp, first + j, obj[j]);
+    if (k != GLP_CV)
+      glp_set_col_kind(lp, first + j, k);
+  }
+}
+
+// load the constraint matrix column by column. The values of sparse
+// columns are used in place, only the row indices are shifted to
+// GLPK's 1-based indexing. Dense columns are scanned for non-zeros
+// without branching such that the loop can be vectorized. Memory is
+// allocated by GLPK as this may run in parallel (and is released with
+// the environment on errors).
+static void Rglpk_load_columns(glp_prob *lp, const Rglpk_data *data) {
+  int m = data->n_rows, i, j, k, len;
+  int *ind = (int *) glp_alloc(m + 1, sizeof(int));
+  double *val = (double *) glp_alloc(m + 1, sizeof(double));
+  const double *col;
+
+  for (j = 0; j < data->n_cols; j++) {
+    if (data->mat_format == RGLPK_MAT_CSC) {
+      len = data->mat_p[j + 1] - data->mat_p[j];
+      for (k = 0; k < len; k++)
+        ind[k + 1] = data->mat_i[data->mat_p[j] + k] + 1;
+      glp_set_mat_col(lp, j + 1, len, ind, &data->mat_v[data->mat_p[j] - 1]);
+      continue;
+    }
+    col = &data->mat_v[(size_t) j * m];
+    len = 0;
+    for (i = 0; i < m; i++) {
+      ind[len + 1] = i + 1;
+      val[len + 1] = col[i];
+      len += col[i] != 0.0;
+    }
+    glp_set_mat_col(lp, j + 1, len, ind, val);
+  }
+  glp_free(ind);
+  glp_free(val);
+}
+
+// load the problem data into the (empty) GLPK problem object 'lp'
+void Rglpk_data_load(glp_prob *lp, const Rglpk_data *data) {
+  int i;
+
+  glp_set_obj_dir(lp, data->maximize ? GLP_MAX : GLP_MIN);
+  if (data->n_rows > 0) {
+    glp_add_rows(lp, data->n_rows);
+    for (i = 0; i < data->n_rows; i++)
+      Rglpk_set_row(lp, i + 1, data->dir[i],
+                    data->lhs ? data->lhs[i] : 0.0, data->rhs[i]);
+  }
+  if (data->n_cols > 0) {
+    glp_add_cols(lp, data->n_cols);
+    Rglpk_set_cols(lp, 1, data->n_cols, data->obj, data->kind, data->n_kind,
+                   data->bounds_lower, data->bounds_upper);
+  }
+  switch (data->mat_format) {
+  case RGLPK_MAT_TRIPLET:
+    // IMPORTANT: as glp_load_matrix requires triplets as vectors of the
+    // form: ia[1] ... ia[n], we have to pass the pointer to the adress
+    // [-1] of the corresponding vector
+    if (data->n_nz > 0)
+      glp_load_matrix(lp, data->n_nz, &data->mat_i[-1], &data->mat_j[-1],
+                      &data->mat_v[-1]);
+    break;
+  case RGLPK_MAT_CSC:
+  case RGLPK_MAT_DENSE:
+    Rglpk_load_columns(lp, data);
+    break;
+  }
+}
+
+// integer control parameter 'name', 'def' if not given
+static int Rglpk_int_control(SEXP x, const char *name, int def) {
+  SEXP elt = Rglpk_get_elt(x, name);
+
+  if (isNull(elt) || asInteger(elt) == NA_INTEGER)
+    return def;
+  return asInteger(elt);
+}
+
+// fill 'control' from the list returned by .check_control_parameters()
+void Rglpk_control_init(Rglpk_control *control, SEXP x) {
+  SEXP elt;
+  int k;
+
+  control->verbose = 0;
+  control->presolve = 0;
+  control->tm_limit = 0;
+  control->method = Rglpk_int_control(x, "method", RGLPK_SIMPLEX);
+  if (control->method < RGLPK_SIMPLEX ||
+      control->method > RGLPK_INTERIOR_CROSSOVER)
+    error("Invalid LP method.");
+
+  control->mip_gap = -1.0;
+  elt = Rglpk_get_elt(x, "mip_gap");
+  if (!isNull(elt) && !ISNAN(asReal(elt)))
+    control->mip_gap = asReal(elt);
+  control->br_tech = Rglpk_int_control(x, "br_tech", -1);
+  control->bt_tech = Rglpk_int_control(x, "bt_tech", -1);
+  control->pp_tech = Rglpk_int_control(x, "pp_tech", -1);
+  control->gmi_cuts = Rglpk_int_control(x, "gmi_cuts", -1);
+  control->mir_cuts = Rglpk_int_control(x, "mir_cuts", -1);
+  control->cov_cuts = Rglpk_int_control(x, "cov_cuts", -1);
+  control->clq_cuts = Rglpk_int_control(x, "clq_cuts", -1);
+  control->fp_heur = Rglpk_int_control(x, "fp_heur", -1);
+  control->ps_heur = Rglpk_int_control(x, "ps_heur", -1);
+  control->out_frq = Rglpk_int_control(x, "out_frq", -1);
+
+  // starting basis as returned by Rglpk_solve_LP()
+  control->col_stat = control->row_stat = NULL;
+  control->n_col_stat = control->n_row_stat = 0;
+  elt = Rglpk_get_elt(x, "basis");
+  if (!isNull(elt)) {
+    control->n_col_stat = length(Rglpk_get_elt(elt, "col_stat"));
+    control->col_stat = Rglpk_int_elt(elt, "col_stat", -1);
+    control->n_row_stat = length(Rglpk_get_elt(elt, "row_stat"));
+    control->row_stat = Rglpk_int_elt(elt, "row_stat", -1);
+    for (k = 0; k < control->n_col_stat; k++)
+      if (control->col_stat[k] < GLP_BS || control->col_stat[k] > GLP_NS)
+        error("Invalid status of column %d in basis.", k + 1);
+    for (k = 0; k < control->n_row_stat; k++)
+      if (control->row_stat[k] < GLP_BS || control->row_stat[k] > GLP_NS)
+        error("Invalid status of row %d in basis.", k + 1);
+  }
+
+  // MIP start, missing values are allowed here
+  control->start = NULL;
+  control->n_start = 0;
+  elt = Rglpk_get_elt(x, "start");
+  if (!isNull(elt)) {
+    if (TYPEOF(elt) != REALSXP)
+      error("MIP start must be a double vector.");
+    control->start = REAL(elt);
+    control->n_start = length(elt);
+  }
+
+  // sensitivity analysis, NULL elements select all rows or columns
+  control->sensitivity = 0;
+  control->sens_rows = control->sens_cols = NULL;
+  control->n_sens_rows = control->n_sens_cols = 0;
+  elt = Rglpk_get_elt(x, "sensitivity");
+  if (!isNull(elt)) {
+    control->sensitivity = 1;
+    if (!isNull(Rglpk_get_elt(elt, "rows"))) {
+      control->n_sens_rows = length(Rglpk_get_elt(elt, "rows"));
+      control->sens_rows = Rglpk_int_elt(elt, "rows", -1);
+    }
+    if (!isNull(Rglpk_get_elt(elt, "cols"))) {
+      control->n_sens_cols = length(Rglpk_get_elt(elt, "cols"));
+      control->sens_cols = Rglpk_int_elt(elt, "cols", -1);
+    }
+  }
+
+  elt = Rglpk_get_elt(x, "verbose");
+  if (!isNull(elt))
+    control->verbose = asInteger(elt) == 1;
+  control->cache = asLogical(Rglpk_get_elt(x, "cache")) == TRUE;
+  control->stats = asLogical(Rglpk_get_elt(x, "stats")) == TRUE;
+
+  // progress recording as prepared by .check_control_parameters()
+  control->progress_size = 0;
+  control->progress_interval = 0.0;
+  control->progress_callback = R_NilValue;
+  elt = Rglpk_get_elt(x, "progress");
+  if (!isNull(elt)) {
+    control->progress_size = asInteger(Rglpk_get_elt(elt, "size"));
+    control->progress_interval = asReal(Rglpk_get_elt(elt, "interval"));
+    if (control->progress_size == NA_INTEGER || control->progress_size < 1 ||
+        ISNAN(control->progress_interval))
+      error("Invalid progress parameters.");
+    control->progress_callback = Rglpk_get_elt(elt, "callback");
+    if (!isNull(control->progress_callback) &&
+        !isFunction(control->progress_callback))
+      error("Progress callback must be a function.");
+  }
+  // lazy constraint separator as prepared by .check_control_parameters()
+  control->lazy = R_NilValue;
+  control->lazy_native = NULL;
+  elt = Rglpk_get_elt(x, "lazy");
+  if (TYPEOF(elt) == EXTPTRSXP) {
+    control->lazy_native = (Rglpk_separator) R_ExternalPtrAddrFn(elt);
+    if (!control->lazy_native)
+      error("Native lazy constraint separator is not available.");
+  } else if (isFunction(elt))
+    control->lazy = elt;
+  else if (!isNull(elt))
+    error("Lazy constraint separator must be a function or a native symbol.");
+  elt = Rglpk_get_elt(x, "presolve");
+  if (!isNull(elt))
+    control->presolve = asInteger(elt) == 1;
+  elt = Rglpk_get_elt(x, "tm_limit");
+  if (!isNull(elt) && asInteger(elt) != NA_INTEGER && asInteger(elt) > 0)
+    control->tm_limit = asInteger(elt);
+  control->interrupted = NULL;
+  Rglpk_control_deadline(control);
+}
+
+// start the time limit: the solve is stopped 'tm_limit' milliseconds
+// from now
+void Rglpk_control_deadline(Rglpk_control *control) {
+  control->deadline = control->tm_limit > 0 ?
+    Rglpk_wall_time() + 1e-3 * control->tm_limit : 0.0;
+}
+
+// check that the control parameters fit a problem with 'm' rows and
+// 'n' columns
+void Rglpk_control_check(const Rglpk_control *control, int m, int n) {
+  int k;
+
+  if (control->col_stat && (control->n_col_stat != n ||
+                            control->n_row_stat != m))
+    error("Basis does not conform with the dimensions of the problem.");
+  if (control->start && control->n_start != n)
+    error("MIP start does not conform with the number of objective variables.");
+  for (k = 0; k < control->n_sens_rows; k++)
+    if (control->sens_rows[k] == NA_INTEGER || control->sens_rows[k] < 1 ||
+        control->sens_rows[k] > m)
+      error("Row index %d for sensitivity analysis out of range.", k + 1);
+  for (k = 0; k < control->n_sens_cols; k++)
+    if (control->sens_cols[k] == NA_INTEGER || control->sens_cols[k] < 1 ||
+        control->sens_cols[k] > n)
+      error("Column index %d for sensitivity analysis out of range.", k + 1);
+}
@@ -0,0 +1,127 @@
+/* Progress of the branch-and-cut solver (control parameter
+ * 'progress'). Incumbent value, best bound, gap and size of the search
+ * tree are recorded at a fixed interval and whenever a new incumbent
+ * is found. The records are kept in a ring buffer of fixed size, i.e.,
+ * only the latest ones are retained. Optionally, an R function is
+ * called with each record.
+ */
+
+#include "Rglpk.h"
+#include <float.h>
+
+static const char *Rglpk_progress_events[] = {"interval", "incumbent"};
+
+// set up recording according to 'control', the buffer is allocated
+// via R_alloc() and hence released at the end of the .Call()
+void Rglpk_progress_init(Rglpk_progress *progress,
+                         const Rglpk_control *control) {
+  int n = control->progress_size;
+
+  progress->size = n;
+  progress->count = 0;
+  progress->interval = control->progress_interval;
+  progress->callback = control->progress_callback;
+  progress->failed = 0;
+  progress->start = progress->last = Rglpk_wall_time();
+  progress->incumbent_seen = 0;
+  progress->last_incumbent = 0.0;
+  progress->time = (double *) R_alloc(n, sizeof(double));
+  progress->incumbent = (double *) R_alloc(n, sizeof(double));
+  progress->bound = (double *) R_alloc(n, sizeof(double));
+  progress->gap = (double *) R_alloc(n, sizeof(double));
+  progress->active_nodes = (int *) R_alloc(n, sizeof(int));
+  progress->nodes = (int *) R_alloc(n, sizeof(int));
+  progress->event = (int *) R_alloc(n, sizeof(int));
+}
+
+// call the R function with record 'k', the search is terminated if it
+// returns FALSE or fails
+static void Rglpk_progress_call(Rglpk_progress *progress, glp_tree *tree,
+                                int k) {
+  static const char *names[] = {"time", "incumbent", "bound", "gap",
+                                "active_nodes", "nodes", "new_incumbent"};
+  SEXP x, nms, call, ret;
+  int i, err = 0;
+
+  x = PROTECT(allocVector(REALSXP, 7));
+  REAL(x)[0] = progress->time[k];
+  REAL(x)[1] = progress->incumbent[k];
+  REAL(x)[2] = progress->bound[k];
+  REAL(x)[3] = progress->gap[k];
+  REAL(x)[4] = progress->active_nodes[k];
+  REAL(x)[5] = progress->nodes[k];
+  REAL(x)[6] = progress->event[k];
+  nms = PROTECT(allocVector(STRSXP, 7));
+  for (i = 0; i < 7; i++)
+    SET_STRING_ELT(nms, i, mkChar(names[i]));
+  setAttrib(x, R_NamesSymbol, nms);
+  call = PROTECT(lang2(progress->callback, x));
+  ret = R_tryEval(call, R_GlobalEnv, &err);
+  if (err) {
+    progress->failed = 1;
+    glp_ios_terminate(tree);
+  } else if (isLogical(ret) && length(ret) == 1 && LOGICAL(ret)[0] == FALSE)
+    glp_ios_terminate(tree);
+  UNPROTECT(3);
+}
+
+// record the state of the search if the interval has passed or a new
+// incumbent has been found since the last record
+void Rglpk_progress_update(Rglpk_progress *progress, glp_tree *tree) {
+  glp_prob *mip = glp_ios_get_prob(tree);
+  int status = glp_mip_status(mip), best = glp_ios_best_node(tree), k;
+  int a_cnt, t_cnt, event;
+  double now = Rglpk_wall_time(), obj = NA_REAL, gap;
+
+  if (status == GLP_FEAS || status == GLP_OPT)
+    obj = glp_mip_obj_val(mip);
+  event = !ISNAN(obj) && (!progress->incumbent_seen ||
+                          obj != progress->last_incumbent);
+  if (!event && now - progress->last < progress->interval)
+    return;
+
+  if (event) {
+    progress->incumbent_seen = 1;
+    progress->last_incumbent = obj;
+  }
+  progress->last = now;
+  k = progress->count++ % progress->size;
+  glp_ios_tree_size(tree, &a_cnt, NULL, &t_cnt);
+  gap = glp_ios_mip_gap(tree);
+  progress->time[k] = now - progress->start;
+  progress->incumbent[k] = obj;
+  progress->bound[k] = best ? glp_ios_node_bound(tree, best) : NA_REAL;
+  progress->gap[k] = gap < DBL_MAX ? gap : NA_REAL;
+  progress->active_nodes[k] = a_cnt;
+  progress->nodes[k] = t_cnt;
+  progress->event[k] = event;
+  if (progress->callback != R_NilValue && !progress->failed)
+    Rglpk_progress_call(progress, tree, k);
+}
+
+// the retained records (oldest first) as list of columns, see
+// glp_format_progress() on the R level
+SEXP Rglpk_progress_list(const Rglpk_progress *progress) {
+  static const char *names[] = {"time", "event", "incumbent", "bound", "gap",
+                                "active_nodes", "nodes", ""};
+  int n = progress->count < progress->size ? progress->count : progress->size;
+  int first = progress->count - n, i, k;
+  SEXP out = PROTECT(mkNamed(VECSXP, names));
+
+  for (i = 0; i < 7; i++)
+    SET_VECTOR_ELT(out, i, allocVector(i == 1 ? STRSXP :
+                                       i > 4 ? INTSXP : REALSXP, n));
+  for (i = 0; i < n; i++) {
+    k = (first + i) % progress->size;
+    REAL(VECTOR_ELT(out, 0))[i] = progress->time[k];
+    SET_STRING_ELT(VECTOR_ELT(out, 1), i,
+                   mkChar(Rglpk_progress_events[progress->event[k]]));
+    REAL(VECTOR_ELT(out, 2))[i] = progress->incumbent[k];
+    REAL(VECTOR_ELT(out, 3))[i] = progress->bound[k];
+    REAL(VECTOR_ELT(out, 4))[i] = progress->gap[k];
+    INTEGER(VECTOR_ELT(out, 5))[i] = progress->active_nodes[k];
+    INTEGER(VECTOR_ELT(out, 6))[i] = progress->nodes[k];
+  }
+  UNPROTECT(1);
+  return out;
+}
@@ -1,83 +1,51 @@
 /* These are the interface functions to GLPK's MPS reader/writer Since
  * 2012-01-11: Rglpk now supports MATHPROG files and retrieves
- * variables names and constraints names. Thanks to Michael Kapler!  
+ * variables names and constraints names. Thanks to Michael Kapler!
  * 2012-09-06: A fix to random segfaults introduced with the patch by
  * Michael has been contributed by Christian Buchta.
+ * The file is parsed only once, all data is retrieved from the same
+ * problem object. The reader keeps no state between calls, several
+ * files can be read in parallel (see R_glp_read_files()).
  */
 
 #include "Rglpk.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
-
-// pointer to problem object.
-static glp_prob *lp = NULL;
-
-// call destructor from the R level to guarantee that data has been
-// copied to R data structures.
-void Rglpk_delete_prob() {
-  extern glp_prob *lp;
-  // delete problem object (if any)
-  if (lp){
-    glp_delete_prob(lp);
-    lp = NULL;
-  }
-  
-}
-
-// read in all necessary elements for retrieving the LP/MILP
-void R_glp_read_file (char **file, int *type, 
-		      int *lp_direction_of_optimization,
-		      int *lp_n_constraints, int *lp_n_objective_vars,
-		      int *lp_n_values_in_constraint_matrix,
-		      int *lp_n_integer_vars, int *lp_n_binary_vars, 
-		      char **lp_prob_name,
-		      char **lp_obj_name,
-		      int *lp_verbosity) {
-
-  int status;
-  extern glp_prob *lp;
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// read file 'file' of type 'type' into the (empty) problem object
+// 'lp'. MathProg models are completed by the data section in file
+// 'data' (if not NULL). Returns zero on success.
+int Rglpk_read_prob(glp_prob *lp, int type, const char *file,
+                    const char *data) {
+  int status = 1;
   glp_tran *tran;
-  const char *str; 
-  jmp_buf env;
 
-  // Patch provided by Xypron: A far jump is used to return if an
-  // error occurs. Prior to that R crashed.
-  if (setjmp(env)) {
-    error("An error occured inside the GLPK library.");
-  } else {
-    glp_error_hook(Rglpk_error_hook, &env);
-
-  // Turn on/off Terminal Output
-  if (*lp_verbosity==1)
-    glp_term_out(GLP_ON);
-  else
-    glp_term_out(GLP_OFF);
-
-  // create problem object 
-  if (lp)
-    glp_delete_prob(lp);
-  lp = glp_create_prob();
-
-  // read file -> gets stored as an GLPK problem object 'lp'
   // which file type do we have?
-  switch (*type){
-  case 1: 
+  switch (type){
+  case 1:
     // Fixed (ancient) MPS Format, param argument currently NULL
-    status = glp_read_mps(lp, GLP_MPS_DECK, NULL, *file);
+    status = glp_read_mps(lp, GLP_MPS_DECK, NULL, file);
     break;
   case 2:
     // Free (modern) MPS format, param argument currently NULL
-    status = glp_read_mps(lp, GLP_MPS_FILE, NULL, *file);
+    status = glp_read_mps(lp, GLP_MPS_FILE, NULL, file);
     break;
   case 3:
     // CPLEX LP Format
-    status = glp_read_lp(lp, NULL, *file);
+    status = glp_read_lp(lp, NULL, file);
     break;
   case 4:
     // MATHPROG Format (based on lpx_read_model function)
     tran = glp_mpl_alloc_wksp();
 
-    status = glp_mpl_read_model(tran, *file, 0);
+    status = glp_mpl_read_model(tran, file, 0);
+    if (!status && data)
+      status = glp_mpl_read_data(tran, data);
 
     if (!status) {
         status = glp_mpl_generate(tran, NULL);
@@ -86,213 +54,471 @@ void R_glp_read_file (char **file, int *type,
         }
     }
     glp_mpl_free_wksp(tran);
-    break;    
-  } 
-
-  // if file read successfully glp_read_* returns zero
-  if ( status != 0 ) {
-    glp_delete_prob(lp);
-    lp = NULL;
-    error("Reading file %s failed", *file);
+    break;
   }
+  return status;
+}
+
+// dimensions and scalar data of the problem in 'lp'. Rows before row
+// 'first' are ignored.
+static void Rglpk_MP_dims(glp_prob *lp, int first, Rglpk_MP *mp) {
+  memset(mp, 0, sizeof(Rglpk_MP));
+  mp->maximize = glp_get_obj_dir(lp) == GLP_MAX;
+  mp->problem_name = glp_get_prob_name(lp);
+  mp->objective_name = glp_get_obj_name(lp);
+  mp->m = glp_get_num_rows(lp) - first + 1;
+  mp->n = glp_get_num_cols(lp);
+  mp->nnz = glp_get_num_nz(lp);
+  if (first > 1)
+    mp->nnz -= glp_get_mat_row(lp, 1, NULL, NULL);
+  mp->n_int = glp_get_num_int(lp);
+  mp->n_bin = glp_get_num_bin(lp);
+}
 
-  // retrieve problem name
-  str = glp_get_prob_name(lp);
-  if (str){
-    *lp_prob_name = (char *) str;
+// retrieve the problem data into the arrays of 'mp'. Row and column
+// names are retrieved if the corresponding arrays are given, they are
+// set to point to the names stored in 'lp' (NULL if unnamed). Only
+// GLPK is called, hence this is safe to be used in parallel.
+static void Rglpk_MP_extract(glp_prob *lp, int first, Rglpk_MP *mp) {
+  int i, j, k, type, len, offset;
+
+  // retrieve column specific data (values, bounds and type)
+  for (j = 0; j < mp->n; j++) {
+    mp->obj[j] = glp_get_obj_coef(lp, j+1);
+    type = glp_get_col_type(lp, j+1);
+    // GLPK reports -DBL_MAX and DBL_MAX for missing bounds
+    mp->lower[j] = (type == GLP_FR || type == GLP_UP) ? R_NegInf
+      : glp_get_col_lb(lp, j+1);
+    mp->upper[j] = (type == GLP_FR || type == GLP_LO) ? R_PosInf
+      : glp_get_col_ub(lp, j+1);
+    // set to TRUE if objective variable is integer or binary
+    mp->is_int[j] = glp_get_col_kind(lp, j+1) == GLP_IV;
+    mp->is_bin[j] = glp_get_col_kind(lp, j+1) == GLP_BV;
+    if (mp->col_names)
+      mp->col_names[j] = glp_get_col_name(lp, j+1);
   }
 
-  // retrieve name of objective function
-  str = glp_get_obj_name(lp);
-  if (str){
-    *lp_obj_name = (char *) str;
+  // retrieve row specific data (right hand side, direction of
+  // constraints) and the constraint matrix row by row
+  offset = 0;
+  for (i = 0; i < mp->m; i++) {
+    k = i + first;
+    mp->dir[i] = glp_get_row_type(lp, k);
+    mp->rhs[i] = mp->lhs[i] = 0.0;
+    switch (mp->dir[i]) {
+    case GLP_LO:
+    case GLP_FX:
+      mp->rhs[i] = glp_get_row_lb(lp, k);
+      break;
+    case GLP_UP:
+      mp->rhs[i] = glp_get_row_ub(lp, k);
+      break;
+    case GLP_DB:
+      mp->rhs[i] = glp_get_row_ub(lp, k);
+      mp->lhs[i] = glp_get_row_lb(lp, k);
+      break;
+    }
+    if (mp->row_names)
+      mp->row_names[i] = glp_get_row_name(lp, k);
+    // glp_get_mat_row() stores the elements in ind[1], ..., ind[len]
+    len = glp_get_mat_row(lp, k, &mp->mat_j[offset - 1],
+                          &mp->mat_v[offset - 1]);
+    for (j = 0; j < len; j++)
+      mp->mat_i[offset + j] = i + 1;
+    offset += len;
   }
-  
-  // retrieve optimization direction flag
-  *lp_direction_of_optimization = glp_get_obj_dir(lp);  
+}
 
-  // retrieve number of constraints
-  *lp_n_constraints = glp_get_num_rows(lp);  
+static SEXP Rglpk_string_or_blank(const char *str) {
+  return ScalarString(str ? mkChar(str) : R_BlankString);
+}
 
-  // retrieve number of objective variables
-  *lp_n_objective_vars = glp_get_num_cols(lp);
+static SEXP Rglpk_names(const char **str, int n) {
+  SEXP out = PROTECT(allocVector(STRSXP, n));
+  int k;
 
-  // retrieve number of non-zero elements in constraint matrix
-  *lp_n_values_in_constraint_matrix = glp_get_num_nz(lp);
+  for (k = 0; k < n; k++)
+    SET_STRING_ELT(out, k, str[k] ? mkChar(str[k]) : R_BlankString);
+  UNPROTECT(1);
+  return out;
+}
 
-  // retrieve number of integer variables
-  *lp_n_integer_vars = glp_get_num_int(lp);
-  
-  // retrieve number of binary variables
-  *lp_n_binary_vars = glp_get_num_bin(lp);
+// allocate the named list returned to R for the problem described by
+// 'mp' and fill in the scalar data. If 'bind' is given, its arrays are
+// set to point into the vectors of the list.
+SEXP Rglpk_MP_list(const Rglpk_MP *mp, Rglpk_MP *bind) {
+  static const char *elts[] = {"maximize", "problem_name", "objective_name",
+                               "n_constraints", "n_objective_vars",
+                               "n_integer_vars", "n_binary_vars",
+                               "n_nonzeros", "objective_coefficients",
+                               "constraint_matrix_i", "constraint_matrix_j",
+                               "constraint_matrix_values",
+                               "direction_of_constraints",
+                               "right_hand_side", "left_hand_side",
+                               "objective_var_is_integer",
+                               "objective_var_is_binary", "bounds_lower",
+                               "bounds_upper", "constraint_names",
+                               "objective_vars_names", ""};
+  SEXP out = PROTECT(mkNamed(VECSXP, elts));
+
+  SET_VECTOR_ELT(out, 0, ScalarLogical(mp->maximize));
+  SET_VECTOR_ELT(out, 1, Rglpk_string_or_blank(mp->problem_name));
+  SET_VECTOR_ELT(out, 2, Rglpk_string_or_blank(mp->objective_name));
+  SET_VECTOR_ELT(out, 3, ScalarInteger(mp->m));
+  SET_VECTOR_ELT(out, 4, ScalarInteger(mp->n));
+  SET_VECTOR_ELT(out, 5, ScalarInteger(mp->n_int));
+  SET_VECTOR_ELT(out, 6, ScalarInteger(mp->n_bin));
+  SET_VECTOR_ELT(out, 7, ScalarInteger(mp->nnz));
+  SET_VECTOR_ELT(out, 8, allocVector(REALSXP, mp->n));
+  SET_VECTOR_ELT(out, 9, allocVector(INTSXP, mp->nnz));
+  SET_VECTOR_ELT(out, 10, allocVector(INTSXP, mp->nnz));
+  SET_VECTOR_ELT(out, 11, allocVector(REALSXP, mp->nnz));
+  SET_VECTOR_ELT(out, 12, allocVector(INTSXP, mp->m));
+  SET_VECTOR_ELT(out, 13, allocVector(REALSXP, mp->m));
+  SET_VECTOR_ELT(out, 14, allocVector(REALSXP, mp->m));
+  SET_VECTOR_ELT(out, 15, allocVector(LGLSXP, mp->n));
+  SET_VECTOR_ELT(out, 16, allocVector(LGLSXP, mp->n));
+  SET_VECTOR_ELT(out, 17, allocVector(REALSXP, mp->n));
+  SET_VECTOR_ELT(out, 18, allocVector(REALSXP, mp->n));
+
+  if (bind) {
+    *bind = *mp;
+    bind->obj = REAL(VECTOR_ELT(out, 8));
+    bind->mat_i = INTEGER(VECTOR_ELT(out, 9));
+    bind->mat_j = INTEGER(VECTOR_ELT(out, 10));
+    bind->mat_v = REAL(VECTOR_ELT(out, 11));
+    bind->dir = INTEGER(VECTOR_ELT(out, 12));
+    bind->rhs = REAL(VECTOR_ELT(out, 13));
+    bind->lhs = REAL(VECTOR_ELT(out, 14));
+    bind->is_int = LOGICAL(VECTOR_ELT(out, 15));
+    bind->is_bin = LOGICAL(VECTOR_ELT(out, 16));
+    bind->lower = REAL(VECTOR_ELT(out, 17));
+    bind->upper = REAL(VECTOR_ELT(out, 18));
+  }
+  UNPROTECT(1);
+  return out;
+}
 
+// retrieve the LP/MILP stored in 'lp' as a named list. If
+// 'ignore_first_row' is set, the first row is dropped (in MPS files
+// this is often the objective function). If 'names' is not set, row
+// and column names are not retrieved.
+SEXP Rglpk_retrieve_MP(glp_prob *lp, int ignore_first_row, int names) {
+  Rglpk_MP mp, data;
+  int first;
+  SEXP out;
+
+  first = ignore_first_row && glp_get_num_rows(lp) > 0 ? 2 : 1;
+  Rglpk_MP_dims(lp, first, &mp);
+  out = PROTECT(Rglpk_MP_list(&mp, &data));
+  if (names) {
+    data.row_names = (const char **) R_alloc(mp.m, sizeof(char *));
+    data.col_names = (const char **) R_alloc(mp.n, sizeof(char *));
+  }
+  Rglpk_MP_extract(lp, first, &data);
+  if (names) {
+    SET_VECTOR_ELT(out, 19, Rglpk_names(data.row_names, mp.m));
+    SET_VECTOR_ELT(out, 20, Rglpk_names(data.col_names, mp.n));
   }
+  UNPROTECT(1);
+  return out;
 }
 
-// retrieve all missing values of LP/MILP
-void Rglpk_retrieve_MP_from_file (char **file, int *type,
-				  int *lp_n_constraints,
-				  int *lp_n_objective_vars,
-				  double *lp_objective_coefficients,
-				  int *lp_constraint_matrix_i,
-				  int *lp_constraint_matrix_j,
-				  double *lp_constraint_matrix_values,
-				  int *lp_direction_of_constraints,
-				  double *lp_right_hand_side,
-				  double *lp_left_hand_side,
-				  int *lp_objective_var_is_integer,
-				  int *lp_objective_var_is_binary,
-				  int *lp_bounds_type,
-				  double *lp_bounds_lower,
-				  double *lp_bounds_upper,
-				  int *lp_ignore_first_row,
-				  int *lp_verbosity,
-				  char **lp_constraint_names,
-				  char **lp_objective_vars_names
-				  ) {
-  extern glp_prob *lp;
-  glp_tran *tran;
-  const char *str; 
-  
-  int i, j, lp_column_kind, tmp;
-  int ind_offset, status;
+// read a LP/MILP from file and return all of its data. 'file' is
+// either a file name or a raw vector holding the contents of the file
+// (which is then streamed to GLPK). The same applies to the MathProg
+// data section 'data', which is NULL if not given.
+SEXP R_glp_read_file(SEXP file, SEXP type, SEXP ignore_first_row, SEXP names,
+                     SEXP verbose, SEXP data) {
+  glp_prob *lp;
+  int status;
+  const char *fname, *dname = NULL;
+  SEXP out = R_NilValue, ptr;
+  Rglpk_stream stream, data_stream;
+  jmp_buf env;
 
-    jmp_buf env;
+  stream.active = data_stream.active = 0;
+  if (TYPEOF(file) == RAWSXP) {
+    if (Rglpk_stream_open(&stream, (const char *) RAW(file), XLENGTH(file)))
+      error("Cannot stream model data to GLPK.");
+    fname = stream.path;
+  } else
+    fname = CHAR(STRING_ELT(file, 0));
+  if (TYPEOF(data) == RAWSXP) {
+    if (Rglpk_stream_open(&data_stream, (const char *) RAW(data),
+                          XLENGTH(data))) {
+      Rglpk_stream_close(&stream);
+      error("Cannot stream model data to GLPK.");
+    }
+    dname = data_stream.path;
+  } else if (!isNull(data))
+    dname = CHAR(STRING_ELT(data, 0));
 
   // Patch provided by Xypron: A far jump is used to return if an
   // error occurs. Prior to that R crashed.
   if (setjmp(env)) {
+    Rglpk_stream_close(&stream);
+    Rglpk_stream_close(&data_stream);
     error("An error occured inside the GLPK library.");
   } else {
     glp_error_hook(Rglpk_error_hook, &env);
 
-  // Turn on/off Terminal Output
-  if (*lp_verbosity==1)
-    glp_term_out(GLP_ON);
-  else
-    glp_term_out(GLP_OFF);
-
-  // create problem object
-  if (lp)
-    glp_delete_prob(lp);
-  lp = glp_create_prob();
+    // Turn on/off Terminal Output
+    glp_term_out(asLogical(verbose) == TRUE ? GLP_ON : GLP_OFF);
+
+    // create problem object and read file, the problem object is owned
+    // by an external pointer such that it gets deleted on R errors too
+    lp = glp_create_prob();
+    ptr = PROTECT(Rglpk_model_wrap(lp));
+    status = Rglpk_read_prob(lp, asInteger(type), fname, dname);
+    Rglpk_stream_close(&stream);
+    Rglpk_stream_close(&data_stream);
+
+    // if file read successfully glp_read_* returns zero
+    if ( status != 0 ) {
+      Rglpk_model_delete(ptr);
+      if (TYPEOF(file) == RAWSXP)
+        error("Reading model data failed");
+      error("Reading file %s failed", fname);
+    }
 
-  // read file -> gets stored as an GLPK problem object 'lp'
-  // which file type do we have?
-  switch (*type){
-  case 1: 
-    // Fixed (ancient) MPS Format, param argument currently NULL
-    status = glp_read_mps(lp, GLP_MPS_DECK, NULL, *file);
-    break;
-  case 2:
-    // Free (modern) MPS format, param argument currently NULL
-    status = glp_read_mps(lp, GLP_MPS_FILE, NULL, *file);
-    break;
-  case 3:
-    // CPLEX LP Format
-    status = glp_read_lp(lp, NULL, *file);
-    break;
-  case 4:
-    // MATHPROG Format (based on lpx_read_model function)
-    tran = glp_mpl_alloc_wksp();
+    if (asLogical(verbose) == TRUE)
+      Rprintf("Retrieve problem data ...\n");
+    out = PROTECT(Rglpk_retrieve_MP(lp, asLogical(ignore_first_row) == TRUE,
+                                    asLogical(names) == TRUE));
+    Rglpk_model_delete(ptr);
+    if (asLogical(verbose) == TRUE)
+      Rprintf("Done.\n");
+    UNPROTECT(2);
+  }
+  return out;
+}
 
-    status = glp_mpl_read_model(tran, *file, 0);
+static void Rglpk_MP_free(Rglpk_MP *mp) {
+  free(mp->obj);
+  free(mp->mat_v);
+  free(mp->rhs);
+  free(mp->lhs);
+  free(mp->lower);
+  free(mp->upper);
+  free(mp->mat_i);
+  free(mp->mat_j);
+  free(mp->dir);
+  free(mp->is_int);
+  free(mp->is_bin);
+  free(mp->row_names);
+  free(mp->col_names);
+  free(mp->pool);
+  memset(mp, 0, sizeof(Rglpk_MP));
+}
 
-    if (!status) {
-        status = glp_mpl_generate(tran, NULL);
-        if (!status) {
-            glp_mpl_build_prob(tran, lp);
-        }
+// copy the strings 'str' into 'pool' (if given) and make 'str' point to
+// the copies. Returns the number of bytes needed.
+static size_t Rglpk_MP_pool(const char **str, int n, char *pool) {
+  size_t size = 0, len;
+  int k;
+
+  for (k = 0; k < n; k++) {
+    if (!str[k])
+      continue;
+    len = strlen(str[k]) + 1;
+    if (pool) {
+      memcpy(pool + size, str[k], len);
+      str[k] = pool + size;
     }
-    glp_mpl_free_wksp(tran);
-    break;    
-  } 
+    size += len;
+  }
+  return size;
+}
 
-  // if file read successfully glp_read_* returns zero
-  if ( status != 0 ) {
-    glp_delete_prob(lp);
-    lp = NULL;
-    error("Reading file %c failed.", *file);
+// names are stored in the problem object which does not survive the
+// thread, copy them into memory owned by 'mp'
+static int Rglpk_MP_keep_names(Rglpk_MP *mp) {
+  const char *scalars[2];
+  size_t size;
+  char *pool;
+
+  scalars[0] = mp->problem_name;
+  scalars[1] = mp->objective_name;
+  size = Rglpk_MP_pool(scalars, 2, NULL);
+  if (mp->row_names)
+    size += Rglpk_MP_pool(mp->row_names, mp->m, NULL);
+  if (mp->col_names)
+    size += Rglpk_MP_pool(mp->col_names, mp->n, NULL);
+  if (!size)
+    return 0;
+  mp->pool = pool = (char *) malloc(size);
+  if (!pool)
+    return 1;
+  pool += Rglpk_MP_pool(scalars, 2, pool);
+  mp->problem_name = scalars[0];
+  mp->objective_name = scalars[1];
+  if (mp->row_names)
+    pool += Rglpk_MP_pool(mp->row_names, mp->m, pool);
+  if (mp->col_names)
+    Rglpk_MP_pool(mp->col_names, mp->n, pool);
+  return 0;
+}
+
+// read a single file into 'mp' using malloc()ed memory. This runs in
+// parallel, hence neither the R API nor R's memory allocation must be
+// used. 'mp->status' is 0 on success, 1 if reading the file failed, 2
+// if an error occured inside the GLPK library, and 3 if running out of
+// memory.
+static void Rglpk_MP_read(Rglpk_MP *mp, const char *file, int type,
+                          int ignore_first_row, int names, int main) {
+  glp_prob *lp;
+  int first;
+  jmp_buf env;
+
+  if (setjmp(env)) {
+    // the problem object is gone with the environment
+    Rglpk_MP_free(mp);
+    mp->status = 2;
+    return;
   }
-  
-  if(*lp_verbosity==1)
-    Rprintf("Retrieve column specific data ...\n");
+  glp_error_hook(main ? Rglpk_error_hook : Rglpk_thread_error_hook, &env);
+  glp_term_out(GLP_OFF);
 
-  if(glp_get_num_cols(lp) != *lp_n_objective_vars) {
+  lp = glp_create_prob();
+  if (Rglpk_read_prob(lp, type, file, NULL) != 0) {
     glp_delete_prob(lp);
-    lp = NULL;
-    error("The number of columns is not as specified");
+    mp->status = 1;
+    return;
   }
-
-  // retrieve column specific data (values, bounds and type)
-  for (i = 0; i < *lp_n_objective_vars; i++) {
-    lp_objective_coefficients[i] = glp_get_obj_coef(lp, i+1);
-    
-    // Note that str must not be freed befor we have returned
-    // from the .C call in R! 
-    str = glp_get_col_name(lp, i+1);    
-    if (str){
-      lp_objective_vars_names[i] = (char *) str;
-    }
-    
-    lp_bounds_type[i]            = glp_get_col_type(lp, i+1);
-    lp_bounds_lower[i]           = glp_get_col_lb  (lp, i+1);
-    lp_bounds_upper[i]           = glp_get_col_ub  (lp, i+1);
-    lp_column_kind               = glp_get_col_kind(lp, i+1);
-    // set to TRUE if objective variable is integer or binary  
-    switch (lp_column_kind){
-    case GLP_IV: 
-      lp_objective_var_is_integer[i] = 1;
-      break;
-    case GLP_BV:
-      lp_objective_var_is_binary[i] = 1;
-      break;
-    }
+  first = ignore_first_row && glp_get_num_rows(lp) > 0 ? 2 : 1;
+  Rglpk_MP_dims(lp, first, mp);
+  // calloc() such that zero sized arrays are no special case
+  mp->obj = (double *) calloc(mp->n + 1, sizeof(double));
+  mp->lower = (double *) calloc(mp->n + 1, sizeof(double));
+  mp->upper = (double *) calloc(mp->n + 1, sizeof(double));
+  mp->is_int = (int *) calloc(mp->n + 1, sizeof(int));
+  mp->is_bin = (int *) calloc(mp->n + 1, sizeof(int));
+  mp->dir = (int *) calloc(mp->m + 1, sizeof(int));
+  mp->rhs = (double *) calloc(mp->m + 1, sizeof(double));
+  mp->lhs = (double *) calloc(mp->m + 1, sizeof(double));
+  mp->mat_i = (int *) calloc(mp->nnz + 1, sizeof(int));
+  mp->mat_j = (int *) calloc(mp->nnz + 1, sizeof(int));
+  mp->mat_v = (double *) calloc(mp->nnz + 1, sizeof(double));
+  if (names) {
+    mp->row_names = (const char **) calloc(mp->m + 1, sizeof(char *));
+    mp->col_names = (const char **) calloc(mp->n + 1, sizeof(char *));
   }
-  
-  ind_offset = 0;
-
-  if(*lp_verbosity==1)
-    Rprintf("Retrieve row specific data ...\n");
-
-  if(glp_get_num_rows(lp) != *lp_n_constraints) {
+  if (!mp->obj || !mp->lower || !mp->upper || !mp->is_int || !mp->is_bin ||
+      !mp->dir || !mp->rhs || !mp->lhs || !mp->mat_i || !mp->mat_j ||
+      !mp->mat_v || (names && (!mp->row_names || !mp->col_names))) {
     glp_delete_prob(lp);
-    lp = NULL;
-    error("The number of rows is not as specified");
+    Rglpk_MP_free(mp);
+    mp->status = 3;
+    return;
   }
+  Rglpk_MP_extract(lp, first, mp);
+  if (Rglpk_MP_keep_names(mp)) {
+    glp_delete_prob(lp);
+    Rglpk_MP_free(mp);
+    mp->status = 3;
+    return;
+  }
+  glp_delete_prob(lp);
+  mp->status = 0;
+}
 
-  // retrieve row specific data (right hand side, direction of constraints)
-  for (i = *lp_ignore_first_row; i < *lp_n_constraints; i++) {
-    lp_direction_of_constraints[i] = glp_get_row_type(lp, i+1);
-    
-    str = glp_get_row_name(lp, i + 1);
-    if (str) { 
-      lp_constraint_names[i] = (char *) str;
-    }
-    
-    // the right hand side. Note we don't allow for double bounded or
-    // free auxiliary variables 
-    if( lp_direction_of_constraints[i] == GLP_LO )
-      lp_right_hand_side[i] = glp_get_row_lb(lp, i+1);
-    if( lp_direction_of_constraints[i] == GLP_UP )
-      lp_right_hand_side[i] = glp_get_row_ub(lp, i+1);
-    if( lp_direction_of_constraints[i] == GLP_FX )
-      lp_right_hand_side[i] = glp_get_row_lb(lp, i+1);
-    if( lp_direction_of_constraints[i] == GLP_DB  ){
-      lp_right_hand_side[i] = glp_get_row_ub(lp, i+1);
-      lp_left_hand_side[i] =  glp_get_row_lb(lp, i+1);
-    }
+// results of R_glp_read_files() not yet handed over to R
+typedef struct {
+  int n;
+  Rglpk_MP *mp;
+} Rglpk_MP_set;
+
+static void Rglpk_MP_set_finalize(SEXP ptr) {
+  Rglpk_MP_set *set = (Rglpk_MP_set *) R_ExternalPtrAddr(ptr);
+  int k;
+
+  if (!set)
+    return;
+  for (k = 0; k < set->n; k++)
+    Rglpk_MP_free(&set->mp[k]);
+  R_Free(set->mp);
+  R_Free(set);
+  R_ClearExternalPtr(ptr);
+}
 
-    tmp = glp_get_mat_row(lp, i+1, &lp_constraint_matrix_j[ind_offset-1],
-			           &lp_constraint_matrix_values[ind_offset-1]);
-    if (tmp > 0)
-      for (j = 0; j < tmp; j++)
-	lp_constraint_matrix_i[ind_offset+j] = i+1;
-	ind_offset += tmp; 
+// read the LPs/MILPs from the files 'files' in parallel using up to
+// 'threads' threads (all available if not positive). Returns a list
+// of the data as returned by R_glp_read_file(), NULL elements for the
+// files which could not be read and the vector of status codes (see
+// Rglpk_MP_read()) as attribute "status".
+SEXP R_glp_read_files(SEXP files, SEXP type, SEXP ignore_first_row,
+                      SEXP names, SEXP threads) {
+  int k, n = length(files), ftype = asInteger(type);
+  int ignore = asLogical(ignore_first_row) == TRUE;
+  int get_names = asLogical(names) == TRUE;
+  int nthreads = asInteger(threads);
+  const char **fnames;
+  Rglpk_MP_set *set;
+  Rglpk_MP data;
+  SEXP out, status, ptr;
+
+  fnames = (const char **) R_alloc(n, sizeof(char *));
+  for (k = 0; k < n; k++)
+    fnames[k] = CHAR(STRING_ELT(files, k));
+
+  set = R_Calloc(1, Rglpk_MP_set);
+  ptr = PROTECT(R_MakeExternalPtr(set, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(ptr, Rglpk_MP_set_finalize, TRUE);
+  set->mp = R_Calloc(n, Rglpk_MP);
+  set->n = n;
+
+#ifdef _OPENMP
+  if (nthreads == NA_INTEGER || nthreads < 1)
+    nthreads = omp_get_max_threads();
+  // GLPK shares one environment between all threads otherwise
+  if (!Rglpk_thread_safe())
+    nthreads = 1;
+#pragma omp parallel num_threads(nthreads)
+  {
+    // each thread reads into its own GLPK environment
+    int main = omp_get_thread_num() == 0;
+#pragma omp for schedule(dynamic)
+    for (k = 0; k < n; k++)
+      Rglpk_MP_read(&set->mp[k], fnames[k], ftype, ignore, get_names, main);
+    // the main thread's environment holds the problem objects alive on
+    // the R level and must be kept
+    if (!main)
+      glp_free_env();
   }
-  
-  if(*lp_verbosity==1)
-    Rprintf("Done.\n");
+#else
+  for (k = 0; k < n; k++)
+    Rglpk_MP_read(&set->mp[k], fnames[k], ftype, ignore, get_names, 1);
+#endif
+
+  out = PROTECT(allocVector(VECSXP, n));
+  status = PROTECT(allocVector(INTSXP, n));
+  for (k = 0; k < n; k++) {
+    INTEGER(status)[k] = set->mp[k].status;
+    if (set->mp[k].status != 0)
+      continue;
+    SET_VECTOR_ELT(out, k, Rglpk_MP_list(&set->mp[k], &data));
+    memcpy(data.obj, set->mp[k].obj, data.n * sizeof(double));
+    memcpy(data.lower, set->mp[k].lower, data.n * sizeof(double));
+    memcpy(data.upper, set->mp[k].upper, data.n * sizeof(double));
+    memcpy(data.is_int, set->mp[k].is_int, data.n * sizeof(int));
+    memcpy(data.is_bin, set->mp[k].is_bin, data.n * sizeof(int));
+    memcpy(data.dir, set->mp[k].dir, data.m * sizeof(int));
+    memcpy(data.rhs, set->mp[k].rhs, data.m * sizeof(double));
+    memcpy(data.lhs, set->mp[k].lhs, data.m * sizeof(double));
+    memcpy(data.mat_i, set->mp[k].mat_i, data.nnz * sizeof(int));
+    memcpy(data.mat_j, set->mp[k].mat_j, data.nnz * sizeof(int));
+    memcpy(data.mat_v, set->mp[k].mat_v, data.nnz * sizeof(double));
+    if (get_names) {
+      SET_VECTOR_ELT(VECTOR_ELT(out, k), 19,
+                     Rglpk_names(set->mp[k].row_names, data.m));
+      SET_VECTOR_ELT(VECTOR_ELT(out, k), 20,
+                     Rglpk_names(set->mp[k].col_names, data.n));
+    }
+    Rglpk_MP_free(&set->mp[k]);
   }
+  setAttrib(out, install("status"), status);
+  Rglpk_MP_set_finalize(ptr);
+  UNPROTECT(3);
+  return out;
 }
-
@@ -0,0 +1,161 @@
+/* Sensitivity analysis of an optimal basic solution, computed via
+ * glp_analyze_bound() and glp_analyze_coef() and returned as numeric
+ * vectors (rather than as the text report of glp_print_ranges()).
+ */
+
+#include "Rglpk.h"
+#include <float.h>
+
+// GLPK reports -DBL_MAX and DBL_MAX for unbounded ranges
+static double Rglpk_range_value(double x) {
+  if (x <= -DBL_MAX)
+    return R_NegInf;
+  if (x >= DBL_MAX)
+    return R_PosInf;
+  return x;
+}
+
+// limiting variable k (GLPK's ordinal numbering: rows 1, ..., m, then
+// columns m + 1, ..., m + n), NA if there is none
+static int Rglpk_range_var(int k) {
+  return k ? k : NA_INTEGER;
+}
+
+// allocate the named list holding vectors of length 'len' and types
+// 'types' for each of 'names', pointers to the data are stored in
+// 'ptr'.
+static SEXP Rglpk_range_list(const char **names, const SEXPTYPE *types,
+                             int len, void **ptr) {
+  SEXP out = PROTECT(mkNamed(VECSXP, names));
+  int k;
+
+  for (k = 0; names[k][0]; k++) {
+    SET_VECTOR_ELT(out, k, allocVector(types[k], len));
+    ptr[k] = types[k] == REALSXP ? (void *) REAL(VECTOR_ELT(out, k))
+                                 : (void *) INTEGER(VECTOR_ELT(out, k));
+  }
+  UNPROTECT(1);
+  return out;
+}
+
+// ranges of the active bound of row or column 'k' (see
+// Rglpk_range_var()) keeping the basis primal feasible. For basic rows
+// the right hand side may move up to the current activity.
+static void Rglpk_bound_range(glp_prob *lp, int k, int stat, int type,
+                              double activity, double *lower, int *lower_var,
+                              double *upper, int *upper_var) {
+  double v1, v2;
+  int k1, k2;
+
+  *lower_var = *upper_var = NA_INTEGER;
+  if (stat != GLP_BS) {
+    glp_analyze_bound(lp, k, &v1, &k1, &v2, &k2);
+    *lower = Rglpk_range_value(v1);
+    *upper = Rglpk_range_value(v2);
+    *lower_var = Rglpk_range_var(k1);
+    *upper_var = Rglpk_range_var(k2);
+    return;
+  }
+  *lower = *upper = NA_REAL;
+  switch (type) {
+  case GLP_UP:
+    *lower = activity;
+    *upper = R_PosInf;
+    break;
+  case GLP_LO:
+    *lower = R_NegInf;
+    *upper = activity;
+    break;
+  }
+}
+
+// sensitivity analysis of the optimal basic solution of 'lp' for the
+// rows and columns requested in 'control'. Returns a list with
+// elements 'rows' and 'columns' or R_NilValue if no optimal basic
+// solution is available.
+SEXP Rglpk_sensitivity(glp_prob *lp, const Rglpk_control *control) {
+  static const char *col_names[] = {"index", "cost_lower", "cost_upper",
+                                    "cost_lower_var", "cost_upper_var",
+                                    "bound_lower", "bound_upper",
+                                    "bound_lower_var", "bound_upper_var", ""};
+  static const SEXPTYPE col_types[] = {INTSXP, REALSXP, REALSXP, INTSXP,
+                                       INTSXP, REALSXP, REALSXP, INTSXP,
+                                       INTSXP};
+  static const char *row_names[] = {"index", "bound_lower", "bound_upper",
+                                    "bound_lower_var", "bound_upper_var", ""};
+  static const SEXPTYPE row_types[] = {INTSXP, REALSXP, REALSXP, INTSXP,
+                                       INTSXP};
+  static const char *names[] = {"rows", "columns", ""};
+  int m = glp_get_num_rows(lp), n = glp_get_num_cols(lp);
+  int n_rows, n_cols, i, j, l, k, k1, k2, stat, max;
+  void *col[9], *row[5];
+  double c, d, v1, v2;
+  SEXP out;
+
+  if (glp_get_num_int(lp) > 0 || glp_get_status(lp) != GLP_OPT)
+    return R_NilValue;
+  // the factorization is not available after using the presolver
+  if (!glp_bf_exists(lp) && glp_factorize(lp) != 0)
+    return R_NilValue;
+
+  n_rows = control->sens_rows ? control->n_sens_rows : m;
+  n_cols = control->sens_cols ? control->n_sens_cols : n;
+  max = glp_get_obj_dir(lp) == GLP_MAX;
+
+  out = PROTECT(mkNamed(VECSXP, names));
+  SET_VECTOR_ELT(out, 0, Rglpk_range_list(row_names, row_types, n_rows, row));
+  SET_VECTOR_ELT(out, 1, Rglpk_range_list(col_names, col_types, n_cols, col));
+
+  for (l = 0; l < n_rows; l++) {
+    i = control->sens_rows ? control->sens_rows[l] : l + 1;
+    ((int *) row[0])[l] = i;
+    Rglpk_bound_range(lp, i, glp_get_row_stat(lp, i), glp_get_row_type(lp, i),
+                      glp_get_row_prim(lp, i), &((double *) row[1])[l],
+                      &((int *) row[3])[l], &((double *) row[2])[l],
+                      &((int *) row[4])[l]);
+  }
+
+  for (l = 0; l < n_cols; l++) {
+    j = control->sens_cols ? control->sens_cols[l] : l + 1;
+    k = m + j;
+    ((int *) col[0])[l] = j;
+    stat = glp_get_col_stat(lp, j);
+    Rglpk_bound_range(lp, k, stat, glp_get_col_type(lp, j),
+                      glp_get_col_prim(lp, j), &((double *) col[5])[l],
+                      &((int *) col[7])[l], &((double *) col[6])[l],
+                      &((int *) col[8])[l]);
+    if (stat == GLP_BS) {
+      glp_analyze_coef(lp, k, &v1, &k1, &c, &v2, &k2, &d);
+      ((double *) col[1])[l] = Rglpk_range_value(v1);
+      ((double *) col[2])[l] = Rglpk_range_value(v2);
+      ((int *) col[3])[l] = Rglpk_range_var(k1);
+      ((int *) col[4])[l] = Rglpk_range_var(k2);
+      continue;
+    }
+    // a nonbasic variable stays optimal as long as its reduced cost
+    // keeps its sign
+    c = glp_get_obj_coef(lp, j);
+    d = glp_get_col_dual(lp, j);
+    v1 = R_NegInf;
+    v2 = R_PosInf;
+    switch (stat) {
+    case GLP_NL:
+    case GLP_NU:
+      // minimizing, at lower bound: d >= 0; at upper bound: d <= 0 (and
+      // the other way round when maximizing)
+      if ((stat == GLP_NL) != max)
+        v1 = c - d;
+      else
+        v2 = c - d;
+      break;
+    case GLP_NF:
+      v1 = v2 = c - d;
+      break;
+    }
+    ((double *) col[1])[l] = v1;
+    ((double *) col[2])[l] = v2;
+    ((int *) col[3])[l] = ((int *) col[4])[l] = NA_INTEGER;
+  }
+  UNPROTECT(1);
+  return out;
+}
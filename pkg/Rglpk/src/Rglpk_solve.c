@@ -3,46 +3,102 @@
 
 #include "Rglpk.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
 
-// this is the solve function called from R
-void R_glp_solve (int *lp_direction, int *lp_number_of_constraints,
-                  int *lp_direction_of_constraints, double *lp_right_hand_side,
-                  int *lp_number_of_objective_vars,
-                  double *lp_objective_coefficients,
-                  int *lp_objective_var_is_integer, 
-                  int *lp_objective_var_is_binary,
-                  int *lp_is_integer,                     //should be boolean
-                  int *lp_number_of_values_in_constraint_matrix,
-                  int *lp_constraint_matrix_i, int *lp_constraint_matrix_j,
-                  double *lp_constraint_matrix_values,
-                  int *lp_bounds_type, double *lp_bounds_lower,
-                  double *lp_bounds_upper,
-                  double *lp_optimum,
-                  int *lp_col_stat,
-                  double *lp_objective_vars_values,
-                  double *lp_objective_dual_values,
-                  int *lp_row_stat,
-                  double *lp_row_prim_aux,
-                  double *lp_row_dual_aux,
-                  int *lp_verbosity,
-                  int *lp_presolve,
-                  int *lp_time_limit,
-                  int *lp_status,
-                  int *write_fmt,
-                  char **fname,
-                  int *write_sensitivity_report,
-                  char **fname_sensitivity_report) {
+// seconds between checks for user interrupts in the branch-and-cut
+// solver
+#define RGLPK_INTERRUPT_INTERVAL 0.1
+
+static const char *Rglpk_termination_reasons[] = {"time_limit", "interrupt",
+                                                  "callback"};
+
+// why the solve returned by Rglpk_run_solver() with 'ret' stopped
+// early (NA if it did not) and, for MIPs, the best bound and the MIP
+// gap at that time
+SEXP Rglpk_termination(glp_prob *lp, int ret, const Rglpk_control *control,
+                       const Rglpk_stats *stats) {
+  static const char *names[] = {"reason", "bound", "gap", ""};
+  int is_integer = glp_get_num_int(lp) > 0, reason = -1;
+  SEXP out = PROTECT(mkNamed(VECSXP, names));
+
+  if (control->interrupted && *control->interrupted)
+    reason = 1;
+  else if (ret == GLP_ETMLIM ||
+           (ret != 0 && control->deadline > 0 &&
+            Rglpk_wall_time() >= control->deadline))
+    reason = 0;
+  else if (ret == GLP_ESTOP)
+    reason = 2;
+  SET_VECTOR_ELT(out, 0, reason < 0 ? ScalarString(NA_STRING) :
+                 mkString(Rglpk_termination_reasons[reason]));
+  SET_VECTOR_ELT(out, 1, ScalarReal(is_integer ? stats->best_bound : NA_REAL));
+  SET_VECTOR_ELT(out, 2, ScalarReal(is_integer ? stats->mip_gap : NA_REAL));
+  UNPROTECT(1);
+  return out;
+}
+
+// this is the solve function called from R. 'x' is the problem data
+// as prepared by glp_prepare_MP(), 'control' the list returned from
+// .check_control_parameters(). If 'write_fmt' is positive the problem
+// is written to file 'fname' instead of being solved.
+SEXP R_glp_solve(SEXP x, SEXP control, SEXP write_fmt, SEXP fname,
+                 SEXP fname_sensitivity_report) {
 
   // GLPK problem object
   glp_prob *lp;
-  // GLPK simplex control object
-  glp_smcp control_sm;
-  // GLPK mixed integer control object
-  glp_iocp control_io;
-  int i, kl, ku;
+  Rglpk_data data;
+  Rglpk_control ctrl;
+  int fmt = asInteger(write_fmt), status, ret, interrupted = 0;
+  SEXP out = R_NilValue, near, term;
+  Rglpk_cache_key key;
+  Rglpk_stats stats;
+  Rglpk_progress progress;
   jmp_buf env;
 
+  // all type, length and NA checks happen here, before any GLPK
+  // object is created. The time limit covers the whole call, hence
+  // the control parameters come first.
+  Rglpk_stats_init(&stats);
+  Rglpk_control_init(&ctrl, control);
+  ctrl.interrupted = &interrupted;
+  Rglpk_data_init(&data, x);
+  Rglpk_control_check(&ctrl, data.n_rows, data.n_cols);
+  Rglpk_stats_phase(&stats, RGLPK_PHASE_VALIDATE);
+
+  // solution cache: return the stored solution of the same problem or
+  // start from the basis of a problem of the same structure. Not used
+  // if the problem is written to file, a sensitivity report, or the
+  // progress of the solver is requested, nor with lazy constraints.
+  ctrl.cache = ctrl.cache && fmt == 0 &&
+    length(fname_sensitivity_report) == 0 && ctrl.progress_size == 0 &&
+    !Rglpk_lazy_given(&ctrl);
+  if (ctrl.cache) {
+    Rglpk_cache_key_init(&key, &data, &ctrl);
+    out = Rglpk_cache_lookup(&key, &near);
+    if (!isNull(out)) {
+      if (!ctrl.stats)
+        return out;
+      // the stored solution must not be modified
+      out = PROTECT(shallow_duplicate(out));
+      stats.cached = 1;
+      setAttrib(out, install("stats"), Rglpk_stats_list(&stats));
+      UNPROTECT(1);
+      return out;
+    }
+    if (!isNull(near) && !ctrl.col_stat && ctrl.method == RGLPK_SIMPLEX &&
+        !isNull(VECTOR_ELT(near, 6))) {
+      ctrl.col_stat = INTEGER(VECTOR_ELT(near, 6));
+      ctrl.n_col_stat = data.n_cols;
+      ctrl.row_stat = INTEGER(VECTOR_ELT(near, 7));
+      ctrl.n_row_stat = data.n_rows;
+    }
+  }
+
   // Patch provided by Xypron: A far jump is used to return if an
   // error occurs. Prior to that R crashed.
   if (setjmp(env)) {
@@ -50,149 +106,593 @@ void R_glp_solve (int *lp_direction, int *lp_number_of_constraints,
   } else {
     glp_error_hook(Rglpk_error_hook, &env);
 
-    // create problem object 
-    lp = glp_create_prob();
-
     // Turn on/off Terminal Output
-    if(*lp_verbosity==1)
-      glp_term_out(GLP_ON);
-    else
-      glp_term_out(GLP_OFF);
-    
-    // direction of optimization
-    if(*lp_direction==1)
-      glp_set_obj_dir(lp, GLP_MAX);
-    else
-      glp_set_obj_dir(lp, GLP_MIN);
-    
-    // is it a mixed integer problem? -- seems to be an R glpk function
-    //if(lp_integer)
-    //lpx_set_class(lp, LPX_MIP);
-    // add rows to the problem object
-    if( *lp_number_of_constraints > 0 ){
-      glp_add_rows(lp, *lp_number_of_constraints);
-      for(i = 0; i < *lp_number_of_constraints; i++)
-        switch(lp_direction_of_constraints[i]){
-        case 1: 
-          glp_set_row_bnds(lp, i+1, GLP_UP, 0.0, lp_right_hand_side[i]);
-          break;
-        case 2: 
-          glp_set_row_bnds(lp, i+1, GLP_UP, 0.0, lp_right_hand_side[i]);
-          break;
-        case 3: 
-          glp_set_row_bnds(lp, i+1, GLP_LO, lp_right_hand_side[i], 0.0);
-          break;
-        case 4: 
-          glp_set_row_bnds(lp, i+1, GLP_LO, lp_right_hand_side[i], 0.0);
-          break;
-        case 5: 
-          glp_set_row_bnds(lp, i+1, GLP_FX, lp_right_hand_side[i],
-                           lp_right_hand_side[i]);
-          break;
-        }
-    }
-    
-    // add columns to the problem object
-    glp_add_cols(lp, *lp_number_of_objective_vars);
-    kl = ku = 0;
-    for(i = 0; i < *lp_number_of_objective_vars; i++) {
-      glp_set_col_bnds(lp, i+1, lp_bounds_type[i], lp_bounds_lower[i], lp_bounds_upper[i]);
-      // set objective coefficients and integer if necessary
-      glp_set_obj_coef(lp, i+1, lp_objective_coefficients[i]);
-      if (lp_objective_var_is_integer[i])
-        glp_set_col_kind(lp, i+1, GLP_IV);
-      if (lp_objective_var_is_binary[i])
-        glp_set_col_kind(lp, i+1, GLP_BV);
-    }
-    // load the matrix
-    // IMPORTANT: as glp_load_matrix requires triplets as vectors of the
-    // form: ia[1] ... ia[n], we have to pass the pointer to the adress
-    // [-1] of the corresponding vector 
-    if( *lp_number_of_constraints > 0 ){
-      glp_load_matrix(lp, *lp_number_of_values_in_constraint_matrix,
-                      &lp_constraint_matrix_i[-1],
-                      &lp_constraint_matrix_j[-1], &lp_constraint_matrix_values[-1]);
-    }
+    glp_term_out(ctrl.verbose ? GLP_ON : GLP_OFF);
+
+    // create problem object and load the problem data
+    lp = glp_create_prob();
+    Rglpk_data_load(lp, &data);
+    Rglpk_stats_phase(&stats, RGLPK_PHASE_BUILD);
 
     // write lp to file
     // mps_fixed := 1L, mps_free := 2L
-    if ( *write_fmt > 0 ) {
-        const char *out_name = fname[0];
-        if ( *write_fmt < 3 ) {
-            *lp_status = glp_write_mps(lp, *write_fmt, NULL, out_name);
-        } else if ( *write_fmt == 3 ) {
-            *lp_status = glp_write_lp(lp, NULL, out_name);
+    if ( fmt > 0 ) {
+        const char *out_name = CHAR(STRING_ELT(fname, 0));
+        if ( fmt < 3 ) {
+            status = glp_write_mps(lp, fmt, NULL, out_name);
+        } else if ( fmt == 3 ) {
+            status = glp_write_lp(lp, NULL, out_name);
         } else {
             int future_flag = 0;
-            *lp_status = glp_write_prob(lp, future_flag, out_name);
+            status = glp_write_prob(lp, future_flag, out_name);
         }
         glp_delete_prob(lp);
-        return;
-    }
-    
-    // set optimizer control parameters
-    glp_init_smcp(&control_sm);
-    if (*lp_time_limit > 0) {
-      control_sm.tm_lim = *lp_time_limit;
-    }
-    if (*lp_presolve == 1) {
-      control_sm.presolve = GLP_ON;
-    }
-    
-    // run simplex method to solve linear problem
-    glp_simplex(lp, &control_sm);
-    
-    // retrieve status of optimization
-    *lp_status = glp_get_status(lp);
-    // retrieve optimum
-    *lp_optimum = glp_get_obj_val(lp);
-    // retrieve values of objective vars
-    for(i = 0; i < *lp_number_of_objective_vars; i++) {
-      lp_col_stat[i] = glp_get_col_stat(lp, i+1);
-      lp_objective_vars_values[i] = glp_get_col_prim(lp, i+1);
-      lp_objective_dual_values[i] = glp_get_col_dual(lp, i+1);
-    }
-    // retrieve primal/dual multipliers
-    for(i = 0; i < *lp_number_of_constraints; i++) {
-      lp_row_stat[i] = glp_get_row_stat(lp, i+1);
-      lp_row_prim_aux[i] = glp_get_row_prim(lp, i+1);
-      lp_row_dual_aux[i] = glp_get_row_dual(lp, i+1);
-    }
-    if(*lp_is_integer) {
-      // set optimizer control parameters
-      glp_init_iocp(&control_io);
-      if (*lp_time_limit > 0) {
-        control_io.tm_lim = *lp_time_limit;
-      }
-      if (*lp_presolve == 1) {
-        control_io.presolve = GLP_ON;
-      }
-      // optimize
-      glp_intopt(lp, &control_io);
-      // retrieve status of optimization
-      *lp_status = glp_mip_status(lp);
-      
-      // retrieve MIP optimum
-      *lp_optimum = glp_mip_obj_val(lp);
-      // retrieve MIP values of objective vars
-      for(i = 0; i < *lp_number_of_objective_vars; i++){
-        lp_objective_vars_values[i] = glp_mip_col_val(lp, i+1);
-      }
-      // retrieve MIP auxiliary variable values
-      for(i = 0; i < *lp_number_of_constraints; i++) {
-        lp_row_prim_aux[i] = glp_mip_row_val(lp, i+1);
-      }
+        return ScalarInteger(status);
     }
 
+    // run the solver(s)
+    if (ctrl.progress_size > 0)
+      Rglpk_progress_init(&progress, &ctrl);
+    // the statistics are always recorded as the best bound and the
+    // MIP gap are returned for MIPs
+    ret = Rglpk_run_solver(lp, &ctrl, 0, &stats,
+                           ctrl.progress_size > 0 ? &progress : NULL);
+
+    // retrieve the solution
+    out = PROTECT(Rglpk_get_solution(lp, Rglpk_solution_type(lp, &ctrl)));
+    term = Rglpk_termination(lp, ret, &ctrl, &stats);
+    setAttrib(out, install("termination"), term);
+    if (ctrl.sensitivity)
+      setAttrib(out, install("sensitivity"), Rglpk_sensitivity(lp, &ctrl));
+    if (ctrl.progress_size > 0)
+      setAttrib(out, install("progress"), Rglpk_progress_list(&progress));
+
     // write sensitivity analysis report
-    if (*write_sensitivity_report == 1) {
-      const char *out_name = fname_sensitivity_report[0];
+    if (length(fname_sensitivity_report) > 0) {
+      const char *out_name = CHAR(STRING_ELT(fname_sensitivity_report, 0));
       glp_print_ranges(lp, 0, NULL, 0, out_name);
     }
 
     // delete problem object
     glp_delete_prob(lp);
+    if (ctrl.progress_size > 0 && progress.failed)
+      warning("Progress callback failed, search terminated.");
+    if (interrupted)
+      warning("Search interrupted, returning the best solution found so far.");
+    // solutions of a terminated solve must not be reused
+    if (ctrl.cache && STRING_ELT(VECTOR_ELT(term, 0), 0) == NA_STRING)
+      Rglpk_cache_insert(&key, out);
+    if (ctrl.stats) {
+      Rglpk_stats_phase(&stats, RGLPK_PHASE_EXTRACT);
+      if (ctrl.cache)
+        out = PROTECT(shallow_duplicate(out));
+      setAttrib(out, install("stats"), Rglpk_stats_list(&stats));
+      if (ctrl.cache)
+        UNPROTECT(1);
+    }
+    UNPROTECT(1);
   }
+  return out;
 }
 
+// milliseconds left until the deadline in 'control' (at least one
+// such that GLPK does not take it for "no limit")
+static int Rglpk_time_left(const Rglpk_control *control) {
+  double left = 1e3 * (control->deadline - Rglpk_wall_time());
 
+  if (left < 1.0)
+    return 1;
+  return left < INT_MAX ? (int) left : INT_MAX;
+}
+
+// set the parameters of the branch-and-cut solver, parameters not
+// given (negative) keep GLPK's defaults
+static void Rglpk_set_iocp(glp_iocp *control_io, const Rglpk_control *control) {
+  if (control->deadline > 0) {
+    control_io->tm_lim = Rglpk_time_left(control);
+  }
+  if (control->presolve) {
+    control_io->presolve = GLP_ON;
+  }
+  if (control->mip_gap >= 0.0)
+    control_io->mip_gap = control->mip_gap;
+  if (control->br_tech >= 0)
+    control_io->br_tech = control->br_tech;
+  if (control->bt_tech >= 0)
+    control_io->bt_tech = control->bt_tech;
+  if (control->pp_tech >= 0)
+    control_io->pp_tech = control->pp_tech;
+  if (control->gmi_cuts >= 0)
+    control_io->gmi_cuts = control->gmi_cuts ? GLP_ON : GLP_OFF;
+  if (control->mir_cuts >= 0)
+    control_io->mir_cuts = control->mir_cuts ? GLP_ON : GLP_OFF;
+  if (control->cov_cuts >= 0)
+    control_io->cov_cuts = control->cov_cuts ? GLP_ON : GLP_OFF;
+  if (control->clq_cuts >= 0)
+    control_io->clq_cuts = control->clq_cuts ? GLP_ON : GLP_OFF;
+  if (control->fp_heur >= 0)
+    control_io->fp_heur = control->fp_heur ? GLP_ON : GLP_OFF;
+  if (control->ps_heur >= 0)
+    control_io->ps_heur = control->ps_heur ? GLP_ON : GLP_OFF;
+  if (control->out_frq >= 0)
+    control_io->out_frq = control->out_frq;
+}
+
+// round the interior point solution of 'lp' to a basis: variables
+// (structural and auxiliary) strictly between their bounds become
+// basic, the others nonbasic at the nearest bound. The number of basic
+// variables is then adjusted to the number of rows, preferring
+// auxiliary variables (slacks) as these keep the basis nonsingular.
+static void Rglpk_crossover_basis(glp_prob *lp) {
+  int m = glp_get_num_rows(lp), n = glp_get_num_cols(lp);
+  int k, type, stat, n_basic = 0;
+  double val, lb, ub, tol = 1e-7;
+
+  for (k = 1; k <= m + n; k++) {
+    if (k <= m) {
+      type = glp_get_row_type(lp, k);
+      val = glp_ipt_row_prim(lp, k);
+      lb = glp_get_row_lb(lp, k);
+      ub = glp_get_row_ub(lp, k);
+    } else {
+      type = glp_get_col_type(lp, k - m);
+      val = glp_ipt_col_prim(lp, k - m);
+      lb = glp_get_col_lb(lp, k - m);
+      ub = glp_get_col_ub(lp, k - m);
+    }
+    switch (type) {
+    case GLP_FX:
+      stat = GLP_NS;
+      break;
+    case GLP_LO:
+      stat = val - lb <= tol * (1.0 + fabs(lb)) ? GLP_NL : GLP_BS;
+      break;
+    case GLP_UP:
+      stat = ub - val <= tol * (1.0 + fabs(ub)) ? GLP_NU : GLP_BS;
+      break;
+    case GLP_DB:
+      stat = val - lb <= tol * (1.0 + fabs(lb)) ? GLP_NL
+        : ub - val <= tol * (1.0 + fabs(ub)) ? GLP_NU : GLP_BS;
+      break;
+    default:
+      stat = GLP_BS;
+    }
+    if (stat == GLP_BS)
+      n_basic++;
+    if (k <= m)
+      glp_set_row_stat(lp, k, stat);
+    else
+      glp_set_col_stat(lp, k - m, stat);
+  }
+  // too few basic variables: add slacks
+  for (k = 1; k <= m && n_basic < m; k++)
+    if (glp_get_row_stat(lp, k) != GLP_BS) {
+      glp_set_row_stat(lp, k, GLP_BS);
+      n_basic++;
+    }
+  // too many basic variables: remove structural variables, then slacks
+  for (k = m + n; k >= 1 && n_basic > m; k--) {
+    stat = k > m ? glp_get_col_stat(lp, k - m) : glp_get_row_stat(lp, k);
+    if (stat != GLP_BS)
+      continue;
+    // GLPK chooses the right nonbasic status for GLP_NL on its own
+    // (glp_set_*_stat() corrects it according to the variable's type)
+    if (k > m)
+      glp_set_col_stat(lp, k - m, GLP_NL);
+    else
+      glp_set_row_stat(lp, k, GLP_NL);
+    n_basic--;
+  }
+}
+
+// run the interior point method on 'lp'. For 'crossover' the interior
+// point solution is rounded to a basis from which the primal simplex
+// is started to obtain a basic (vertex) solution.
+static int Rglpk_run_interior(glp_prob *lp, glp_smcp *control_sm,
+                              int crossover) {
+  // GLPK interior point control object
+  glp_iptcp control_ipt;
+  int ret;
+
+  glp_init_iptcp(&control_ipt);
+  ret = glp_interior(lp, &control_ipt);
+  if (!crossover)
+    return ret;
+  if (ret == 0 && glp_ipt_status(lp) == GLP_OPT)
+    Rglpk_crossover_basis(lp);
+  else
+    glp_adv_basis(lp, 0);
+  control_sm->meth = GLP_PRIMAL;
+  // the presolver would discard the basis
+  control_sm->presolve = GLP_OFF;
+  ret = glp_simplex(lp, control_sm);
+  if (ret == GLP_EBADB || ret == GLP_ESING || ret == GLP_ECOND) {
+    glp_adv_basis(lp, 0);
+    ret = glp_simplex(lp, control_sm);
+  }
+  return ret;
+}
+
+// data passed to the branch-and-cut callback Rglpk_ios_callback()
+typedef struct {
+  // MIP start (1-based), NULL if not available
+  double *start;
+  // statistics to update, NULL if not requested
+  Rglpk_stats *stats;
+  // progress records, NULL if not requested
+  Rglpk_progress *progress;
+  // deadline, interrupt flag and lazy constraint separator, time of
+  // the last check for interrupts
+  const Rglpk_control *control;
+  double last_check;
+  // buffers passed to the lazy constraint separator, set if it
+  // returned an invalid row
+  double *lazy_x;
+  int *lazy_mark;
+  int lazy_invalid;
+} Rglpk_ios_info;
+
+// record the size of the search tree, the best bound and the MIP gap
+static void Rglpk_ios_stats(glp_tree *tree, Rglpk_stats *stats) {
+  int a_cnt, t_cnt, best = glp_ios_best_node(tree);
+  double gap = glp_ios_mip_gap(tree);
+
+  glp_ios_tree_size(tree, &a_cnt, NULL, &t_cnt);
+  stats->nodes = t_cnt;
+  stats->active_nodes = a_cnt;
+  if (best)
+    stats->best_bound = glp_ios_node_bound(tree, best);
+  // without an incumbent the gap is reported as DBL_MAX
+  stats->mip_gap = gap < DBL_MAX ? gap : NA_REAL;
+}
+
+static void Rglpk_check_interrupt(void *data) {
+  R_CheckUserInterrupt();
+}
+
+// whether the user interrupted, without jumping out of the caller
+int Rglpk_user_interrupt(void) {
+  return !R_ToplevelExec(Rglpk_check_interrupt, NULL);
+}
+
+// stop the search if the deadline has passed or the user interrupted
+// it. GLPK's own time limit is only checked between nodes, and an
+// interrupt must not jump out of GLPK, hence it is caught via
+// R_ToplevelExec(). Checking for interrupts processes pending events,
+// hence this is done at most every RGLPK_INTERRUPT_INTERVAL seconds.
+static void Rglpk_ios_terminate(glp_tree *tree, Rglpk_ios_info *ios) {
+  const Rglpk_control *control = ios->control;
+  double now = Rglpk_wall_time();
+
+  if (control->deadline > 0 && now >= control->deadline) {
+    glp_ios_terminate(tree);
+    return;
+  }
+  if (!control->interrupted ||
+      now - ios->last_check < RGLPK_INTERRUPT_INTERVAL)
+    return;
+  ios->last_check = now;
+  if (Rglpk_user_interrupt()) {
+    *control->interrupted = 1;
+    glp_ios_terminate(tree);
+  }
+}
+
+// callback of the branch-and-cut solver
+static void Rglpk_ios_callback(glp_tree *tree, void *info) {
+  Rglpk_ios_info *ios = (Rglpk_ios_info *) info;
+  int ret;
+
+  if (ios->stats)
+    Rglpk_ios_stats(tree, ios->stats);
+  if (ios->progress)
+    Rglpk_progress_update(ios->progress, tree);
+  Rglpk_ios_terminate(tree, ios);
+  switch (glp_ios_reason(tree)) {
+  case GLP_IHEUR:
+    // offer the MIP start as soon as the first heuristic solution is
+    // requested, GLPK itself rejects it if it is not feasible
+    if (ios->start) {
+      glp_ios_heur_sol(tree, ios->start);
+      ios->start = NULL;
+    }
+    break;
+  case GLP_IROWGEN:
+    // without the separator the solutions cannot be trusted
+    if (Rglpk_lazy_given(ios->control)) {
+      ret = Rglpk_lazy_separate(tree, ios->control, ios->lazy_x,
+                                ios->lazy_mark);
+      if (ret == 2)
+        ios->lazy_invalid = 1;
+      if (ret)
+        glp_ios_terminate(tree);
+    }
+    break;
+  }
+}
+
+// complete the MIP start given in 'control' to an integer feasible
+// solution: the integer variables given are fixed to their (rounded)
+// values in a copy of 'lp' and the remaining problem is solved. The
+// solution is stored in 'x' (1-based). Returns zero on success.
+static int Rglpk_complete_start(glp_prob *lp, const Rglpk_control *control,
+                                double *x) {
+  glp_prob *fix = glp_create_prob();
+  glp_iocp control_io;
+  int j, ret, n = glp_get_num_cols(lp);
+  double v;
+
+  glp_copy_prob(fix, lp, GLP_OFF);
+  for (j = 1; j <= n; j++) {
+    v = control->start[j - 1];
+    if (ISNAN(v) || glp_get_col_kind(fix, j) == GLP_CV)
+      continue;
+    v = nearbyint(v);
+    glp_set_col_bnds(fix, j, GLP_FX, v, v);
+  }
+  glp_init_iocp(&control_io);
+  control_io.msg_lev = GLP_MSG_OFF;
+  control_io.presolve = GLP_ON;
+  if (control->deadline > 0) {
+    control_io.tm_lim = Rglpk_time_left(control);
+  }
+  ret = glp_intopt(fix, &control_io);
+  if (ret == 0 && (glp_mip_status(fix) == GLP_OPT ||
+                   glp_mip_status(fix) == GLP_FEAS)) {
+    for (j = 1; j <= n; j++)
+      x[j] = glp_mip_col_val(fix, j);
+  } else {
+    ret = 1;
+  }
+  glp_delete_prob(fix);
+  return ret;
+}
+
+// install the starting basis given in 'control'
+static void Rglpk_set_basis(glp_prob *lp, const Rglpk_control *control) {
+  int k;
+
+  for (k = 0; k < control->n_row_stat; k++)
+    glp_set_row_stat(lp, k + 1, control->row_stat[k]);
+  for (k = 0; k < control->n_col_stat; k++)
+    glp_set_col_stat(lp, k + 1, control->col_stat[k]);
+}
+
+// run the LP method chosen in 'control' and, for problems with integer
+// variables, the branch-and-cut solver on 'lp'. If 'warm' is set (or a
+// starting basis is given in 'control') the simplex starts from the
+// current basis of 'lp' and falls back to an advanced initial basis if
+// the current one turns out to be invalid. RGLPK_WARM_PRIMAL selects
+// the primal simplex, which suits changes of the objective only.
+// Times and counters are recorded in 'stats', the progress of the
+// branch-and-cut solver in 'progress' unless these are NULL. The
+// solve stops at the deadline given in 'control' and, unless
+// 'control->interrupted' is NULL, when the user interrupts the
+// branch-and-cut solver. Recording progress and checking for
+// interrupts calls R and hence must not be used in parallel.
+int Rglpk_run_solver(glp_prob *lp, const Rglpk_control *control, int warm,
+                     Rglpk_stats *stats, Rglpk_progress *progress) {
+  // GLPK simplex control object
+  glp_smcp control_sm;
+  // GLPK mixed integer control object
+  glp_iocp control_io;
+  Rglpk_ios_info ios;
+  double *start = NULL;
+  int ret = 0, is_integer = glp_get_num_int(lp) > 0;
+  int lazy = is_integer && Rglpk_lazy_given(control);
+  int it_cnt = Rglpk_iteration_count(lp);
+
+  glp_init_smcp(&control_sm);
+  if (control->deadline > 0) {
+    control_sm.tm_lim = Rglpk_time_left(control);
+  }
+  if (control->presolve) {
+    control_sm.presolve = GLP_ON;
+  }
+  if (control->col_stat && control->method == RGLPK_SIMPLEX) {
+    Rglpk_set_basis(lp, control);
+    // the presolver would discard the basis
+    control_sm.presolve = GLP_OFF;
+    warm = 1;
+  }
+  // after small changes of the problem the retained basis usually
+  // stays dual feasible, hence we use the dual simplex (switching to
+  // the primal one if it is not). If only the objective changed it
+  // stays primal feasible. The presolver would discard the basis.
+  if (warm) {
+    control_sm.meth = warm == RGLPK_WARM_PRIMAL ? GLP_PRIMAL : GLP_DUALP;
+    control_sm.presolve = GLP_OFF;
+  }
+  // with the MIP presolver turned on glp_intopt() solves the LP
+  // relaxation itself, there is no need to run the simplex beforehand
+  if (is_integer && control->presolve && !control->start && !lazy) {
+    ret = 0;
+  } else if (control->method != RGLPK_SIMPLEX) {
+    // branch-and-cut needs an optimal basis, hence MIPs always use
+    // crossover
+    ret = Rglpk_run_interior(lp, &control_sm, is_integer ||
+                             control->method == RGLPK_INTERIOR_CROSSOVER);
+  } else {
+    ret = glp_simplex(lp, &control_sm);
+    if (warm && (ret == GLP_EBADB || ret == GLP_ESING || ret == GLP_ECOND)) {
+      glp_adv_basis(lp, 0);
+      ret = glp_simplex(lp, &control_sm);
+    }
+  }
+  if (stats)
+    Rglpk_stats_phase(stats, RGLPK_PHASE_LP);
+
+  if (is_integer) {
+    glp_init_iocp(&control_io);
+    Rglpk_set_iocp(&control_io, control);
+    ios.start = NULL;
+    ios.stats = stats;
+    ios.progress = progress;
+    ios.control = control;
+    ios.last_check = Rglpk_wall_time();
+    ios.lazy_x = NULL;
+    ios.lazy_mark = NULL;
+    ios.lazy_invalid = 0;
+    if (lazy) {
+      // the callback must see the original problem, and solutions
+      // found by the heuristics would not be checked by the separator
+      control_io.presolve = GLP_OFF;
+      control_io.fp_heur = GLP_OFF;
+      control_io.ps_heur = GLP_OFF;
+#if GLP_MAJOR_VERSION > 4 || GLP_MINOR_VERSION >= 57
+      control_io.sr_heur = GLP_OFF;
+#endif
+      // GLPK's allocator, see the MIP start below
+      ios.lazy_x = (double *) glp_alloc(glp_get_num_cols(lp) + 1,
+                                        sizeof(double));
+      ios.lazy_mark = (int *) glp_alloc(glp_get_num_cols(lp) + 1,
+                                        sizeof(int));
+      memset(ios.lazy_mark, 0, (glp_get_num_cols(lp) + 1) * sizeof(int));
+    }
+    if (control->start) {
+      // the callback sees the presolved problem otherwise
+      control_io.presolve = GLP_OFF;
+      // GLPK's allocator as this might run in parallel (each thread
+      // has its own environment) and the memory is released with the
+      // environment if a GLPK error occurs
+      start = (double *) glp_alloc(glp_get_num_cols(lp) + 1, sizeof(double));
+      if (Rglpk_complete_start(lp, control, start) == 0)
+        ios.start = start;
+    }
+    control_io.cb_func = Rglpk_ios_callback;
+    control_io.cb_info = &ios;
+    ret = glp_intopt(lp, &control_io);
+    if (start)
+      glp_free(start);
+    if (lazy) {
+      glp_free(ios.lazy_x);
+      glp_free(ios.lazy_mark);
+      if (ios.lazy_invalid)
+        warning("Lazy constraint separator returned an invalid row, search terminated.");
+    }
+    if (stats) {
+      Rglpk_stats_phase(stats, RGLPK_PHASE_MIP);
+      // the search tree has been explored completely
+      if (ret == 0 && glp_mip_status(lp) == GLP_OPT) {
+        stats->best_bound = glp_mip_obj_val(lp);
+        stats->mip_gap = 0.0;
+        stats->active_nodes = 0;
+      }
+    }
+  }
+  if (stats && it_cnt != NA_INTEGER)
+    stats->iterations = Rglpk_iteration_count(lp) - it_cnt;
+  return ret;
+}
+
+// which solution to retrieve after a call to Rglpk_run_solver()
+int Rglpk_solution_type(glp_prob *lp, const Rglpk_control *control) {
+  if (glp_get_num_int(lp) > 0)
+    return GLP_MIP;
+  return control->method == RGLPK_INTERIOR ? GLP_IPT : GLP_SOL;
+}
+
+// allocate the named list returned to R for a solution of type 'type'
+// (GLP_SOL, GLP_IPT, or GLP_MIP) of a problem with 'm' rows and 'n'
+// columns and make the arrays of 'sol' point into its vectors. Dual
+// values are only available for linear programs, basis status only
+// for basic solutions.
+SEXP Rglpk_solution_list(int m, int n, int type, Rglpk_solution *sol) {
+  static const char *names[] = {"status", "optimum", "solution",
+                                "solution_dual", "row_primal", "row_dual",
+                                "col_stat", "row_stat", ""};
+  SEXP out = PROTECT(mkNamed(VECSXP, names));
+
+  memset(sol, 0, sizeof(Rglpk_solution));
+  sol->m = m;
+  sol->n = n;
+  sol->type = type;
+  SET_VECTOR_ELT(out, 2, allocVector(REALSXP, n));
+  sol->x = REAL(VECTOR_ELT(out, 2));
+  SET_VECTOR_ELT(out, 4, allocVector(REALSXP, m));
+  sol->row = REAL(VECTOR_ELT(out, 4));
+  if (type != GLP_MIP) {
+    SET_VECTOR_ELT(out, 3, allocVector(REALSXP, n));
+    sol->x_dual = REAL(VECTOR_ELT(out, 3));
+    SET_VECTOR_ELT(out, 5, allocVector(REALSXP, m));
+    sol->row_dual = REAL(VECTOR_ELT(out, 5));
+  }
+  if (type == GLP_SOL) {
+    SET_VECTOR_ELT(out, 6, allocVector(INTSXP, n));
+    sol->col_stat = INTEGER(VECTOR_ELT(out, 6));
+    SET_VECTOR_ELT(out, 7, allocVector(INTSXP, m));
+    sol->row_stat = INTEGER(VECTOR_ELT(out, 7));
+  }
+  UNPROTECT(1);
+  return out;
+}
+
+// set status and optimum of the list allocated by Rglpk_solution_list()
+void Rglpk_solution_finish(SEXP out, const Rglpk_solution *sol) {
+  SET_VECTOR_ELT(out, 0, ScalarInteger(sol->status));
+  SET_VECTOR_ELT(out, 1, ScalarReal(sol->optimum));
+}
+
+// retrieve the solution of 'lp' after a call to Rglpk_run_solver()
+// into the arrays of 'sol', values of integer variables are rounded.
+// Only GLPK is called, hence this is safe to be used in parallel.
+void Rglpk_solution_extract(glp_prob *lp, Rglpk_solution *sol) {
+  int i;
+  double obj;
+
+  switch (sol->type) {
+  case GLP_MIP:
+    sol->status = glp_mip_status(lp);
+    // the objective value at the rounded solution
+    obj = glp_get_obj_coef(lp, 0);
+    for (i = 0; i < sol->n; i++) {
+      sol->x[i] = glp_mip_col_val(lp, i+1);
+      if (glp_get_col_kind(lp, i+1) != GLP_CV)
+        sol->x[i] = nearbyint(sol->x[i]);
+      obj += glp_get_obj_coef(lp, i+1) * sol->x[i];
+    }
+    sol->optimum = obj;
+    for (i = 0; i < sol->m; i++)
+      sol->row[i] = glp_mip_row_val(lp, i+1);
+    break;
+  case GLP_IPT:
+    sol->status = glp_ipt_status(lp);
+    sol->optimum = glp_ipt_obj_val(lp);
+    for (i = 0; i < sol->n; i++) {
+      sol->x[i] = glp_ipt_col_prim(lp, i+1);
+      sol->x_dual[i] = glp_ipt_col_dual(lp, i+1);
+    }
+    for (i = 0; i < sol->m; i++) {
+      sol->row[i] = glp_ipt_row_prim(lp, i+1);
+      sol->row_dual[i] = glp_ipt_row_dual(lp, i+1);
+    }
+    break;
+  default:
+    sol->status = glp_get_status(lp);
+    sol->optimum = glp_get_obj_val(lp);
+    for (i = 0; i < sol->n; i++) {
+      sol->col_stat[i] = glp_get_col_stat(lp, i+1);
+      sol->x[i] = glp_get_col_prim(lp, i+1);
+      sol->x_dual[i] = glp_get_col_dual(lp, i+1);
+    }
+    for (i = 0; i < sol->m; i++) {
+      sol->row_stat[i] = glp_get_row_stat(lp, i+1);
+      sol->row[i] = glp_get_row_prim(lp, i+1);
+      sol->row_dual[i] = glp_get_row_dual(lp, i+1);
+    }
+  }
+}
+
+// retrieve the solution of type 'type' of 'lp' after a call to
+// Rglpk_run_solver() as a named list
+SEXP Rglpk_get_solution(glp_prob *lp, int type) {
+  Rglpk_solution sol;
+  SEXP out;
+
+  out = PROTECT(Rglpk_solution_list(glp_get_num_rows(lp),
+                                     glp_get_num_cols(lp), type, &sol));
+  Rglpk_solution_extract(lp, &sol);
+  Rglpk_solution_finish(out, &sol);
+  UNPROTECT(1);
+  return out;
+}
@@ -0,0 +1,130 @@
+/* Statistics of a solve (control parameter 'stats'): wall clock and
+ * CPU times of the phases of R_glp_solve() and the work counters of
+ * the solvers. Wall clock times are taken from a monotonic clock.
+ */
+
+#include "Rglpk.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static const char *Rglpk_phase_names[] = {"validate", "build", "lp", "mip",
+                                          "extract"};
+
+// seconds elapsed since some fixed point in time
+double Rglpk_wall_time(void) {
+#ifdef _WIN32
+  LARGE_INTEGER count, freq;
+
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+  return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+// CPU time used by the process in seconds
+double Rglpk_cpu_time(void) {
+#ifdef _WIN32
+  FILETIME create, exit, kernel, user;
+
+  GetProcessTimes(GetCurrentProcess(), &create, &exit, &kernel, &user);
+  return 1e-7 * ((((unsigned long long) kernel.dwHighDateTime << 32) |
+                  kernel.dwLowDateTime) +
+                 (((unsigned long long) user.dwHighDateTime << 32) |
+                  user.dwLowDateTime));
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+#endif
+}
+
+void Rglpk_stats_init(Rglpk_stats *stats) {
+  int k;
+
+  for (k = 0; k < RGLPK_N_PHASES; k++)
+    stats->wall[k] = stats->cpu[k] = 0.0;
+  stats->iterations = NA_INTEGER;
+  stats->nodes = stats->active_nodes = NA_INTEGER;
+  stats->mip_gap = stats->best_bound = NA_REAL;
+  stats->cached = 0;
+  Rglpk_stats_start(stats);
+}
+
+// start timing a phase
+void Rglpk_stats_start(Rglpk_stats *stats) {
+  stats->wall_start = Rglpk_wall_time();
+  stats->cpu_start = Rglpk_cpu_time();
+}
+
+// add the time since the last call of Rglpk_stats_start() (or
+// Rglpk_stats_phase()) to phase 'phase' and start timing the next one
+void Rglpk_stats_phase(Rglpk_stats *stats, int phase) {
+  double wall = Rglpk_wall_time(), cpu = Rglpk_cpu_time();
+
+  stats->wall[phase] += wall - stats->wall_start;
+  stats->cpu[phase] += cpu - stats->cpu_start;
+  stats->wall_start = wall;
+  stats->cpu_start = cpu;
+}
+
+// simplex iterations carried out on 'lp' so far (NA if not available
+// with the GLPK version used)
+int Rglpk_iteration_count(glp_prob *lp) {
+#ifdef HAVE_GLP_GET_IT_CNT
+  return glp_get_it_cnt(lp);
+#else
+  return NA_INTEGER;
+#endif
+}
+
+static SEXP Rglpk_phase_times(const double *x) {
+  SEXP out = PROTECT(allocVector(REALSXP, RGLPK_N_PHASES)), names;
+  int k;
+
+  names = PROTECT(allocVector(STRSXP, RGLPK_N_PHASES));
+  for (k = 0; k < RGLPK_N_PHASES; k++) {
+    REAL(out)[k] = x[k];
+    SET_STRING_ELT(names, k, mkChar(Rglpk_phase_names[k]));
+  }
+  setAttrib(out, R_NamesSymbol, names);
+  UNPROTECT(2);
+  return out;
+}
+
+// the statistics as named list, see glp_format_stats() on the R level
+SEXP Rglpk_stats_list(const Rglpk_stats *stats) {
+  static const char *names[] = {"wall", "cpu", "iterations", "nodes",
+                                "active_nodes", "mip_gap", "best_bound",
+                                "cached", ""};
+  SEXP out = PROTECT(mkNamed(VECSXP, names));
+
+  SET_VECTOR_ELT(out, 0, Rglpk_phase_times(stats->wall));
+  SET_VECTOR_ELT(out, 1, Rglpk_phase_times(stats->cpu));
+  SET_VECTOR_ELT(out, 2, ScalarInteger(stats->iterations));
+  SET_VECTOR_ELT(out, 3, ScalarInteger(stats->nodes));
+  SET_VECTOR_ELT(out, 4, ScalarInteger(stats->active_nodes));
+  SET_VECTOR_ELT(out, 5, ScalarReal(stats->mip_gap));
+  SET_VECTOR_ELT(out, 6, ScalarReal(stats->best_bound));
+  SET_VECTOR_ELT(out, 7, ScalarLogical(stats->cached));
+  UNPROTECT(1);
+  return out;
+}
+
+// current wall clock and CPU time, used to time the phases on the R
+// level
+SEXP R_glp_times(void) {
+  SEXP out = allocVector(REALSXP, 2);
+
+  REAL(out)[0] = Rglpk_wall_time();
+  REAL(out)[1] = Rglpk_cpu_time();
+  return out;
+}
@@ -0,0 +1,85 @@
+/* Model data held in memory is handed to GLPK's file readers (which
+ * only accept file names) through a pipe: a writer thread feeds the
+ * data into the pipe while GLPK reads from "/dev/fd/N". No temporary
+ * file is involved. On Windows, where this is not available, the R
+ * code writes the data to a temporary file instead.
+ */
+
+#include "Rglpk.h"
+#ifndef _WIN32
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+// feed the data into the pipe. The write end is non-blocking such that
+// the thread can be stopped if the reader gives up (e.g., on errors).
+static void *Rglpk_stream_write(void *arg) {
+  Rglpk_stream *stream = (Rglpk_stream *) arg;
+  size_t offset = 0;
+  ssize_t len;
+  struct pollfd pfd;
+  sigset_t set;
+
+  // writing to a pipe without reader must not raise SIGPIPE
+  sigemptyset(&set);
+  sigaddset(&set, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+  pfd.fd = stream->fd[1];
+  pfd.events = POLLOUT;
+  while (offset < stream->size && !stream->stop) {
+    if (poll(&pfd, 1, 100) <= 0)
+      continue;
+    len = write(stream->fd[1], stream->buf + offset, stream->size - offset);
+    if (len < 0) {
+      if (errno == EAGAIN || errno == EINTR)
+        continue;
+      break;
+    }
+    offset += len;
+  }
+  close(stream->fd[1]);
+  return NULL;
+}
+#endif
+
+// start streaming 'size' bytes at 'buf', the data can then be read
+// from the file 'stream->path'. Returns non-zero on failure.
+int Rglpk_stream_open(Rglpk_stream *stream, const char *buf, size_t size) {
+  stream->active = 0;
+#ifdef _WIN32
+  return 1;
+#else
+  stream->buf = buf;
+  stream->size = size;
+  stream->stop = 0;
+  if (pipe(stream->fd))
+    return 1;
+  fcntl(stream->fd[1], F_SETFL, fcntl(stream->fd[1], F_GETFL) | O_NONBLOCK);
+  snprintf(stream->path, sizeof(stream->path), "/dev/fd/%d", stream->fd[0]);
+  if (pthread_create(&stream->writer, NULL, Rglpk_stream_write, stream)) {
+    close(stream->fd[0]);
+    close(stream->fd[1]);
+    return 1;
+  }
+  stream->active = 1;
+  return 0;
+#endif
+}
+
+// stop streaming, this is a no-op if the stream is not active
+void Rglpk_stream_close(Rglpk_stream *stream) {
+#ifndef _WIN32
+  if (!stream->active)
+    return;
+  stream->stop = 1;
+  close(stream->fd[0]);
+  pthread_join(stream->writer, NULL);
+  stream->active = 0;
+#endif
+}
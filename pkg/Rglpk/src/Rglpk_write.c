@@ -0,0 +1,506 @@
+/* Streaming writer for problems in MPS (fixed and free) and CPLEX LP
+ * format. The text is formatted straight from the problem data passed
+ * down from R (see Rglpk_data_init()) into a buffer of fixed size, no
+ * GLPK problem object is built. Names of rows and columns are the ones
+ * used by GLPK's writers for unnamed problems. Output is gzip
+ * compressed on request (if the package has been built with zlib).
+ */
+
+#include "Rglpk.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <float.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#define RGLPK_WRITE_BUF (1 << 16)
+// longest single piece of text formatted at once
+#define RGLPK_WRITE_MAX 256
+// line length at which CPLEX LP expressions are wrapped
+#define RGLPK_LP_LINE 72
+
+typedef struct {
+  FILE *fp;
+#ifdef HAVE_ZLIB
+  gzFile gz;
+#endif
+  char *buf;
+  size_t len;
+  int failed;
+  int line; // length of the current line
+  int pending; // MPS: second entry of the current line still free
+} Rglpk_writer;
+
+// access to the constraint matrix by rows or columns ('major'). The
+// elements of major index k are at positions start[k], ...,
+// start[k + 1] - 1, referring to elements perm[p] (p if NULL). Dense
+// matrices have no index at all ('start' is NULL). An index is only
+// built if the elements are not yet grouped as needed.
+typedef struct {
+  const Rglpk_data *data;
+  int by_row, n_minor;
+  const int *start, *perm, *minor;
+} Rglpk_mat_index;
+
+static void Rglpk_flush(Rglpk_writer *w) {
+  if (w->len > 0 && !w->failed) {
+#ifdef HAVE_ZLIB
+    if (w->gz) {
+      if (gzwrite(w->gz, w->buf, (unsigned) w->len) != (int) w->len)
+        w->failed = 1;
+    } else
+#endif
+    if (fwrite(w->buf, 1, w->len, w->fp) != w->len)
+      w->failed = 1;
+  }
+  w->len = 0;
+}
+
+static void Rglpk_printf(Rglpk_writer *w, const char *fmt, ...) {
+  va_list ap;
+  int len;
+
+  if (RGLPK_WRITE_BUF - w->len < RGLPK_WRITE_MAX)
+    Rglpk_flush(w);
+  va_start(ap, fmt);
+  len = vsnprintf(w->buf + w->len, RGLPK_WRITE_MAX, fmt, ap);
+  va_end(ap);
+  if (len < 0 || len >= RGLPK_WRITE_MAX) {
+    w->failed = 1;
+    return;
+  }
+  w->len += len;
+  w->line = fmt[strlen(fmt) - 1] == '\n' ? 0 : w->line + len;
+}
+
+// format 'x' with 15 significant digits (as GLPK does), in fixed MPS
+// format the number is shortened to fit into 12 characters
+static const char *Rglpk_num(char *s, double x, int fixed) {
+  int prec;
+
+  if (!fixed) {
+    snprintf(s, 32, "%.*g", DBL_DIG, x);
+    return s;
+  }
+  for (prec = 12; prec > 1; prec--) {
+    snprintf(s, 32, "%.*g", prec, x);
+    if (strlen(s) <= 12)
+      break;
+  }
+  return s;
+}
+
+// bounds and kind of column j (0-based) as loaded by Rglpk_set_cols()
+static int Rglpk_col_bounds(const Rglpk_data *d, int j, double *lb,
+                            double *ub) {
+  int k = d->kind[j % d->n_kind];
+
+  *lb = d->bounds_lower ? d->bounds_lower[j] : 0.0;
+  *ub = d->bounds_upper ? d->bounds_upper[j] : R_PosInf;
+  if (k == GLP_BV) {
+    if (*lb == *ub)
+      return GLP_IV;
+    *lb = 0.0;
+    *ub = 1.0;
+  }
+  return k;
+}
+
+static int Rglpk_row_type(const Rglpk_data *d, int i, double *lb, double *ub) {
+  return Rglpk_row_bounds(d->dir[i], d->lhs ? d->lhs[i] : 0.0, d->rhs[i], lb,
+                          ub);
+}
+
+// major index of element e of a sparse matrix (0-based)
+static int Rglpk_mat_major(const Rglpk_data *d, int by_row, int e) {
+  if (d->mat_format == RGLPK_MAT_CSC)
+    return d->mat_i[e];
+  return (by_row ? d->mat_i[e] : d->mat_j[e]) - 1;
+}
+
+static void Rglpk_index_init(Rglpk_mat_index *ix, const Rglpk_data *d,
+                             int by_row) {
+  int n_major = by_row ? d->n_rows : d->n_cols, nz = d->n_nz, sorted = 1;
+  int e, j, k, prev = 0, *start, *next, *perm, *minor = NULL;
+
+  ix->data = d;
+  ix->by_row = by_row;
+  ix->n_minor = by_row ? d->n_cols : d->n_rows;
+  ix->start = ix->perm = ix->minor = NULL;
+  if (d->mat_format == RGLPK_MAT_DENSE)
+    return;
+  if (d->mat_format == RGLPK_MAT_CSC && !by_row) {
+    ix->start = d->mat_p;
+    return;
+  }
+
+  // counting sort of the elements by major index
+  start = (int *) R_alloc(n_major + 1, sizeof(int));
+  memset(start, 0, (n_major + 1) * sizeof(int));
+  for (e = 0; e < nz; e++) {
+    k = Rglpk_mat_major(d, by_row, e);
+    start[k + 1]++;
+    sorted &= k >= prev;
+    prev = k;
+  }
+  for (k = 0; k < n_major; k++)
+    start[k + 1] += start[k];
+  ix->start = start;
+  if (sorted && d->mat_format == RGLPK_MAT_TRIPLET)
+    return;
+
+  next = (int *) R_alloc(n_major + 1, sizeof(int));
+  memcpy(next, start, (n_major + 1) * sizeof(int));
+  perm = (int *) R_alloc(nz > 0 ? nz : 1, sizeof(int));
+  if (d->mat_format == RGLPK_MAT_CSC) {
+    // the column of an element is not stored in CSC form
+    minor = (int *) R_alloc(nz > 0 ? nz : 1, sizeof(int));
+    for (j = 0; j < d->n_cols; j++)
+      for (e = d->mat_p[j]; e < d->mat_p[j + 1]; e++) {
+        minor[next[d->mat_i[e]]] = j;
+        perm[next[d->mat_i[e]]++] = e;
+      }
+  } else {
+    for (e = 0; e < nz; e++)
+      perm[next[Rglpk_mat_major(d, by_row, e)]++] = e;
+  }
+  ix->perm = perm;
+  ix->minor = minor;
+}
+
+static void Rglpk_mat_range(const Rglpk_mat_index *ix, int k, int *from,
+                            int *to) {
+  if (ix->start) {
+    *from = ix->start[k];
+    *to = ix->start[k + 1];
+  } else {
+    *from = 0;
+    *to = ix->n_minor;
+  }
+}
+
+// minor index (0-based) and value of the element at position p of
+// major index k
+static int Rglpk_mat_elt(const Rglpk_mat_index *ix, int k, int p,
+                         double *val) {
+  const Rglpk_data *d = ix->data;
+  int m = d->n_rows, e;
+
+  if (!ix->start) {
+    *val = ix->by_row ? d->mat_v[k + (size_t) p * m]
+                      : d->mat_v[p + (size_t) k * m];
+    return p;
+  }
+  e = ix->perm ? ix->perm[p] : p;
+  *val = d->mat_v[e];
+  if (ix->minor)
+    return ix->minor[p];
+  if (d->mat_format == RGLPK_MAT_CSC)
+    return d->mat_i[e];
+  return (ix->by_row ? d->mat_j[e] : d->mat_i[e]) - 1;
+}
+
+// names of rows (1-based, 0 is the objective) and columns
+static const char *Rglpk_mps_row(char *s, int i) {
+  snprintf(s, 32, "R%07d", i);
+  return s;
+}
+
+static const char *Rglpk_mps_col(char *s, int j) {
+  snprintf(s, 32, "C%07d", j);
+  return s;
+}
+
+// an MPS data line with fields 'head', 'name' and value 'val'. Two
+// entries are put on a line, the line is completed by
+// Rglpk_mps_end().
+static void Rglpk_mps_entry(Rglpk_writer *w, int fixed, const char *head,
+                            const char *name, double val) {
+  char num[32];
+
+  Rglpk_num(num, val, fixed);
+  if (w->pending) {
+    Rglpk_printf(w, fixed ? "   %-8s  %12s\n" : " %s %s\n", name, num);
+    w->pending = 0;
+  } else {
+    Rglpk_printf(w, fixed ? "    %-8s  %-8s  %12s" : " %s %s %s", head, name,
+                 num);
+    w->pending = 1;
+  }
+}
+
+static void Rglpk_mps_end(Rglpk_writer *w) {
+  if (w->pending)
+    Rglpk_printf(w, "\n");
+  w->pending = 0;
+}
+
+static void Rglpk_mps_bound(Rglpk_writer *w, int fixed, const char *type,
+                            const char *col, double val) {
+  char num[32];
+
+  Rglpk_num(num, val, fixed);
+  Rglpk_printf(w, fixed ? " %-2s BND1      %-8s  %12s\n" : " %s BND1 %s %s\n",
+               type, col, num);
+}
+
+static void Rglpk_write_mps(Rglpk_writer *w, const Rglpk_data *d,
+                            const Rglpk_mat_index *ix, int fixed) {
+  int m = d->n_rows, n = d->n_cols, i, j, p, from, to, type, kind, len,
+      marker = 0, n_markers = 0;
+  double lb, ub, val;
+  char row[32], col[32];
+  static const char row_type[] = {' ', 'N', 'G', 'L', 'G', 'E'};
+
+  Rglpk_printf(w, "* Problem:    written by Rglpk\n");
+  Rglpk_printf(w, "* Rows:       %d\n", m);
+  Rglpk_printf(w, "* Columns:    %d\n", n);
+  Rglpk_printf(w, "* Objective:  %s\n",
+               d->maximize ? "negated (maximization problem)" : "minimization");
+  Rglpk_printf(w, "NAME\n");
+  Rglpk_printf(w, "ROWS\n");
+  Rglpk_printf(w, " N  %s\n", Rglpk_mps_row(row, 0));
+  // double bounded rows are 'G' rows with a range
+  for (i = 0; i < m; i++)
+    Rglpk_printf(w, " %c  %s\n", row_type[Rglpk_row_type(d, i, &lb, &ub)],
+                 Rglpk_mps_row(row, i + 1));
+
+  // MPS has no direction of optimization, we minimize the negated
+  // objective (as before)
+  Rglpk_printf(w, "COLUMNS\n");
+  for (j = 0; j < n; j++) {
+    kind = Rglpk_col_bounds(d, j, &lb, &ub);
+    if ((kind != GLP_CV) != marker) {
+      marker = !marker;
+      Rglpk_printf(w, fixed ? "    M%07d  'MARKER'                 '%s'\n"
+                            : " M%07d 'MARKER' '%s'\n",
+                   ++n_markers, marker ? "INTORG" : "INTEND");
+    }
+    Rglpk_mps_col(col, j + 1);
+    val = d->maximize ? -d->obj[j] : d->obj[j];
+    len = val != 0.0;
+    if (len)
+      Rglpk_mps_entry(w, fixed, col, Rglpk_mps_row(row, 0), val);
+    Rglpk_mat_range(ix, j, &from, &to);
+    for (p = from; p < to; p++) {
+      i = Rglpk_mat_elt(ix, j, p, &val);
+      if (val != 0.0) {
+        Rglpk_mps_entry(w, fixed, col, Rglpk_mps_row(row, i + 1), val);
+        len++;
+      }
+    }
+    // empty columns are given by a zero objective coefficient
+    if (!len)
+      Rglpk_mps_entry(w, fixed, col, Rglpk_mps_row(row, 0), 0.0);
+    Rglpk_mps_end(w);
+  }
+  if (marker)
+    Rglpk_printf(w, fixed ? "    M%07d  'MARKER'                 'INTEND'\n"
+                          : " M%07d 'MARKER' 'INTEND'\n", ++n_markers);
+
+  Rglpk_printf(w, "RHS\n");
+  for (i = 0; i < m; i++) {
+    type = Rglpk_row_type(d, i, &lb, &ub);
+    val = type == GLP_UP ? ub : type == GLP_FR ? 0.0 : lb;
+    if (val != 0.0)
+      Rglpk_mps_entry(w, fixed, "RHS1", Rglpk_mps_row(row, i + 1), val);
+  }
+  Rglpk_mps_end(w);
+
+  Rglpk_printf(w, "RANGES\n");
+  for (i = 0; i < m; i++)
+    if (Rglpk_row_type(d, i, &lb, &ub) == GLP_DB)
+      Rglpk_mps_entry(w, fixed, "RNG1", Rglpk_mps_row(row, i + 1), ub - lb);
+  Rglpk_mps_end(w);
+
+  // integer columns default to 0 <= x <= 1 in MPS, hence all of their
+  // bounds are given explicitly
+  Rglpk_printf(w, "BOUNDS\n");
+  for (j = 0; j < n; j++) {
+    kind = Rglpk_col_bounds(d, j, &lb, &ub);
+    type = Rglpk_bound_type(lb, ub);
+    Rglpk_mps_col(col, j + 1);
+    if (type == GLP_FX) {
+      Rglpk_mps_bound(w, fixed, "FX", col, lb);
+      continue;
+    }
+    if (type == GLP_FR) {
+      Rglpk_printf(w, fixed ? " FR BND1      %s\n" : " FR BND1 %s\n", col);
+      continue;
+    }
+    if (lb == R_NegInf)
+      Rglpk_printf(w, fixed ? " MI BND1      %s\n" : " MI BND1 %s\n", col);
+    else if (lb != 0.0 || kind != GLP_CV)
+      Rglpk_mps_bound(w, fixed, "LO", col, lb);
+    if (ub != R_PosInf)
+      Rglpk_mps_bound(w, fixed, "UP", col, ub);
+    else if (kind != GLP_CV)
+      Rglpk_printf(w, fixed ? " PL BND1      %s\n" : " PL BND1 %s\n", col);
+  }
+  Rglpk_printf(w, "ENDATA\n");
+}
+
+// a term of a linear form in CPLEX LP format, long lines are wrapped
+static void Rglpk_lp_term(Rglpk_writer *w, double val, const char *name,
+                          int j) {
+  char num[32];
+
+  if (w->line > RGLPK_LP_LINE)
+    Rglpk_printf(w, "\n");
+  Rglpk_num(num, val < 0.0 ? -val : val, 0);
+  Rglpk_printf(w, " %c %s %s%d", val < 0.0 ? '-' : '+', num, name, j);
+}
+
+static void Rglpk_write_lp(Rglpk_writer *w, const Rglpk_data *d,
+                           const Rglpk_mat_index *ix) {
+  int m = d->n_rows, n = d->n_cols, i, j, p, from, to, type, kind, len,
+      n_rows = 0;
+  double lb, ub, val;
+  char num[32], num2[32];
+
+  Rglpk_printf(w, "\\* Problem: written by Rglpk *\\\n\n");
+  Rglpk_printf(w, d->maximize ? "Maximize\n" : "Minimize\n");
+  Rglpk_printf(w, " obj:");
+  for (j = 0, len = 0; j < n; j++)
+    if (d->obj[j] != 0.0) {
+      Rglpk_lp_term(w, d->obj[j], "x_", j + 1);
+      len++;
+    }
+  Rglpk_printf(w, len ? "\n\n" : " 0 x_1\n\n");
+
+  // free rows cannot be given in CPLEX LP format (and do not restrict
+  // the problem), double bounded rows are written as equations with a
+  // bounded auxiliary variable (as GLPK does)
+  Rglpk_printf(w, "Subject To\n");
+  for (i = 0; i < m; i++) {
+    type = Rglpk_row_type(d, i, &lb, &ub);
+    if (type == GLP_FR)
+      continue;
+    Rglpk_printf(w, " r_%d:", i + 1);
+    Rglpk_mat_range(ix, i, &from, &to);
+    for (p = from, len = 0; p < to; p++) {
+      j = Rglpk_mat_elt(ix, i, p, &val);
+      if (val != 0.0) {
+        Rglpk_lp_term(w, val, "x_", j + 1);
+        len++;
+      }
+    }
+    if (!len)
+      Rglpk_printf(w, " 0 x_1");
+    switch (type) {
+    case GLP_LO:
+      Rglpk_printf(w, " >= %s\n", Rglpk_num(num, lb, 0));
+      break;
+    case GLP_UP:
+      Rglpk_printf(w, " <= %s\n", Rglpk_num(num, ub, 0));
+      break;
+    case GLP_FX:
+      Rglpk_printf(w, " = %s\n", Rglpk_num(num, lb, 0));
+      break;
+    case GLP_DB:
+      Rglpk_printf(w, " - ~r_%d = %s\n", i + 1, Rglpk_num(num, lb, 0));
+      break;
+    }
+    n_rows++;
+  }
+  // the constraints section must not be empty
+  if (!n_rows)
+    Rglpk_printf(w, " r_0: 0 x_1 >= 0\n");
+
+  Rglpk_printf(w, "\nBounds\n");
+  for (j = 0; j < n; j++) {
+    kind = Rglpk_col_bounds(d, j, &lb, &ub);
+    if (kind == GLP_BV)
+      continue;
+    switch (Rglpk_bound_type(lb, ub)) {
+    case GLP_FR:
+      Rglpk_printf(w, " x_%d free\n", j + 1);
+      break;
+    case GLP_LO:
+      if (lb != 0.0)
+        Rglpk_printf(w, " x_%d >= %s\n", j + 1, Rglpk_num(num, lb, 0));
+      break;
+    case GLP_UP:
+      Rglpk_printf(w, " -inf <= x_%d <= %s\n", j + 1, Rglpk_num(num, ub, 0));
+      break;
+    case GLP_DB:
+      Rglpk_printf(w, " %s <= x_%d <= %s\n", Rglpk_num(num, lb, 0), j + 1,
+                   Rglpk_num(num2, ub, 0));
+      break;
+    case GLP_FX:
+      Rglpk_printf(w, " x_%d = %s\n", j + 1, Rglpk_num(num, lb, 0));
+      break;
+    }
+  }
+  for (i = 0; i < m; i++)
+    if (Rglpk_row_type(d, i, &lb, &ub) == GLP_DB)
+      Rglpk_printf(w, " 0 <= ~r_%d <= %s\n", i + 1, Rglpk_num(num, ub - lb, 0));
+
+  for (kind = GLP_IV; kind <= GLP_BV; kind++) {
+    for (j = 0, len = 0; j < n; j++) {
+      if (Rglpk_col_bounds(d, j, &lb, &ub) != kind)
+        continue;
+      if (!len++)
+        Rglpk_printf(w, kind == GLP_IV ? "\nGenerals\n" : "\nBinary\n");
+      Rglpk_printf(w, " x_%d\n", j + 1);
+    }
+  }
+  Rglpk_printf(w, "\nEnd\n");
+}
+
+// write the problem data 'x' (as prepared by glp_prepare_MP()) to
+// 'file' in MPS fixed (1), MPS free (2) or CPLEX LP (3) format. Returns
+// 0 on success, 1 otherwise.
+SEXP R_glp_write_file(SEXP x, SEXP type, SEXP file, SEXP compress) {
+  Rglpk_data data;
+  Rglpk_mat_index ix;
+  Rglpk_writer w;
+  int fmt = asInteger(type), gz = asLogical(compress) == TRUE;
+  const char *fname;
+
+  if (fmt < 1 || fmt > 3)
+    error("Invalid file format.");
+  if (!isString(file) || length(file) != 1)
+    error("Invalid file name.");
+  fname = translateChar(STRING_ELT(file, 0));
+#ifndef HAVE_ZLIB
+  if (gz)
+    error("Compressed output is not available, the package has been built without zlib.");
+#endif
+  Rglpk_data_init(&data, x);
+  if (fmt == 1 && (data.n_rows > 9999999 || data.n_cols > 9999999))
+    error("Too many rows or columns for fixed MPS format.");
+  if (fmt == 3 && data.n_cols == 0)
+    error("CPLEX LP format requires at least one objective variable.");
+  // MPS is written by columns, CPLEX LP by rows
+  Rglpk_index_init(&ix, &data, fmt == 3);
+
+  memset(&w, 0, sizeof(w));
+  w.buf = R_alloc(RGLPK_WRITE_BUF, sizeof(char));
+#ifdef HAVE_ZLIB
+  if (gz) {
+    if (!(w.gz = gzopen(fname, "wb")))
+      return ScalarInteger(1);
+  } else
+#endif
+  if (!(w.fp = fopen(fname, "w")))
+    return ScalarInteger(1);
+
+  if (fmt < 3)
+    Rglpk_write_mps(&w, &data, &ix, fmt == 1);
+  else
+    Rglpk_write_lp(&w, &data, &ix);
+  Rglpk_flush(&w);
+
+#ifdef HAVE_ZLIB
+  if (w.gz) {
+    if (gzclose(w.gz) != Z_OK)
+      w.failed = 1;
+  } else
+#endif
+  if (fclose(w.fp))
+    w.failed = 1;
+  return ScalarInteger(w.failed);
+}
@@ -2,77 +2,74 @@
 #include <Rinternals.h>
 #include <R_ext/Rdynload.h>
 
-void R_glp_solve (int *lp_direction, int *lp_number_of_constraints,
-                  int *lp_direction_of_constraints, double *lp_right_hand_side,
-                  int *lp_number_of_objective_vars,
-                  double *lp_objective_coefficients,
-                  int *lp_objective_var_is_integer, 
-                  int *lp_objective_var_is_binary,
-                  int *lp_is_integer,                     //should be boolean
-                  int *lp_number_of_values_in_constraint_matrix,
-                  int *lp_constraint_matrix_i, int *lp_constraint_matrix_j,
-                  double *lp_constraint_matrix_values,
-                  int *lp_bounds_type, double *lp_bounds_lower,
-                  double *lp_bounds_upper,
-                  double *lp_optimum,
-                  int *lp_col_stat,
-                  double *lp_objective_vars_values,
-                  double *lp_objective_dual_values,
-                  int *lp_row_stat,
-                  double *lp_row_prim_aux,
-                  double *lp_row_dual_aux,
-                  int *lp_verbosity,
-                  int *lp_presolve,
-                  int *lp_time_limit,
-                  int *lp_status,
-                  int *write_fmt,
-                  char **fname,
-                  int *write_sensitivity_report,
-                  char **fname_sensitivity_report);
+SEXP R_glp_solve(SEXP x, SEXP control, SEXP write_fmt, SEXP fname,
+                 SEXP fname_sensitivity_report);
+SEXP R_glp_solve_batch(SEXP x, SEXP control, SEXP tm_limit, SEXP threads);
+SEXP R_glp_solve_parametric(SEXP x, SEXP control, SEXP rows, SEXP rhs,
+                            SEXP cols, SEXP obj, SEXP outputs);
 void Rglpk_initialize(void);
 void Rglpk_get_engine_version(char **GLPK_version);
-void R_glp_read_file (char **file, int *type, 
-                      int *lp_direction_of_optimization,
-                      int *lp_n_constraints, int *lp_n_objective_vars,
-                      int *lp_n_values_in_constraint_matrix,
-                      int *lp_n_integer_vars, int *lp_n_binary_vars, 
-                      char **lp_prob_name,
-                      char **lp_obj_name,
-                      int *lp_verbosity);
-void Rglpk_delete_prob();
-void Rglpk_retrieve_MP_from_file (char **file, int *type,
-                                  int *lp_n_constraints,
-                                  int *lp_n_objective_vars,
-                                  double *lp_objective_coefficients,
-                                  int *lp_constraint_matrix_i,
-                                  int *lp_constraint_matrix_j,
-                                  double *lp_constraint_matrix_values,
-                                  int *lp_direction_of_constraints,
-                                  double *lp_right_hand_side,
-                                  double *lp_left_hand_side,
-                                  int *lp_objective_var_is_integer,
-                                  int *lp_objective_var_is_binary,
-                                  int *lp_bounds_type,
-                                  double *lp_bounds_lower,
-                                  double *lp_bounds_upper,
-                                  int *lp_ignore_first_row,
-                                  int *lp_verbosity,
-                                  char **lp_constraint_names,
-                                  char **lp_objective_vars_names
-                                  );
+SEXP R_glp_read_file(SEXP file, SEXP type, SEXP ignore_first_row, SEXP names,
+                     SEXP verbose, SEXP data);
+SEXP R_glp_read_mps(SEXP file, SEXP type, SEXP ignore_first_row, SEXP names,
+                    SEXP verbose);
+SEXP R_glp_read_files(SEXP files, SEXP type, SEXP ignore_first_row,
+                      SEXP names, SEXP threads);
+SEXP R_glp_write_file(SEXP x, SEXP type, SEXP file, SEXP compress);
+SEXP R_glp_mpl_data(SEXP data);
+SEXP R_glp_model_create(SEXP x);
+SEXP R_glp_model_dim(SEXP ptr);
+SEXP R_glp_model_set_rhs(SEXP ptr, SEXP i, SEXP rhs);
+SEXP R_glp_model_set_obj(SEXP ptr, SEXP j, SEXP obj);
+SEXP R_glp_model_set_bounds(SEXP ptr, SEXP j, SEXP lower, SEXP upper);
+SEXP R_glp_model_set_mat(SEXP ptr, SEXP i, SEXP j, SEXP v);
+SEXP R_glp_model_add_rows(SEXP ptr, SEXP dir, SEXP lhs, SEXP rhs, SEXP i,
+                          SEXP j, SEXP v);
+SEXP R_glp_model_add_cols(SEXP ptr, SEXP obj, SEXP kind, SEXP bounds, SEXP i,
+                          SEXP j, SEXP v);
+SEXP R_glp_model_del_rows(SEXP ptr, SEXP i);
+SEXP R_glp_model_del_cols(SEXP ptr, SEXP j);
+SEXP R_glp_model_solve(SEXP ptr, SEXP control);
+SEXP R_glp_cache_stats(void);
+SEXP R_glp_times(void);
+SEXP R_glp_cache_clear(SEXP keep_stats);
+SEXP R_glp_cache_budget(SEXP budget);
 
 static const R_CMethodDef CEntries[] = {
-    {"R_glp_solve", (DL_FUNC) &R_glp_solve, 31},
     {"Rglpk_initialize", (DL_FUNC) &Rglpk_initialize, 0},
     {"Rglpk_get_engine_version", (DL_FUNC) &Rglpk_get_engine_version, 1},
-    {"R_glp_read_file", (DL_FUNC) &R_glp_read_file, 11},
-    {"Rglpk_delete_prob", (DL_FUNC) &Rglpk_delete_prob, 0},
-    {"Rglpk_retrieve_MP_from_file", (DL_FUNC) &Rglpk_retrieve_MP_from_file, 20},
+    {NULL, NULL, 0}
+};
+
+static const R_CallMethodDef CallEntries[] = {
+    {"R_glp_solve", (DL_FUNC) &R_glp_solve, 5},
+    {"R_glp_solve_batch", (DL_FUNC) &R_glp_solve_batch, 4},
+    {"R_glp_solve_parametric", (DL_FUNC) &R_glp_solve_parametric, 7},
+    {"R_glp_read_file", (DL_FUNC) &R_glp_read_file, 6},
+    {"R_glp_read_mps", (DL_FUNC) &R_glp_read_mps, 5},
+    {"R_glp_read_files", (DL_FUNC) &R_glp_read_files, 5},
+    {"R_glp_write_file", (DL_FUNC) &R_glp_write_file, 4},
+    {"R_glp_mpl_data", (DL_FUNC) &R_glp_mpl_data, 1},
+    {"R_glp_model_create", (DL_FUNC) &R_glp_model_create, 1},
+    {"R_glp_model_dim", (DL_FUNC) &R_glp_model_dim, 1},
+    {"R_glp_model_set_rhs", (DL_FUNC) &R_glp_model_set_rhs, 3},
+    {"R_glp_model_set_obj", (DL_FUNC) &R_glp_model_set_obj, 3},
+    {"R_glp_model_set_bounds", (DL_FUNC) &R_glp_model_set_bounds, 4},
+    {"R_glp_model_set_mat", (DL_FUNC) &R_glp_model_set_mat, 4},
+    {"R_glp_model_add_rows", (DL_FUNC) &R_glp_model_add_rows, 7},
+    {"R_glp_model_add_cols", (DL_FUNC) &R_glp_model_add_cols, 7},
+    {"R_glp_model_del_rows", (DL_FUNC) &R_glp_model_del_rows, 2},
+    {"R_glp_model_del_cols", (DL_FUNC) &R_glp_model_del_cols, 2},
+    {"R_glp_model_solve", (DL_FUNC) &R_glp_model_solve, 2},
+    {"R_glp_cache_stats", (DL_FUNC) &R_glp_cache_stats, 0},
+    {"R_glp_times", (DL_FUNC) &R_glp_times, 0},
+    {"R_glp_cache_clear", (DL_FUNC) &R_glp_cache_clear, 1},
+    {"R_glp_cache_budget", (DL_FUNC) &R_glp_cache_budget, 1},
     {NULL, NULL, 0}
 };
 
 void R_init_Rglpk(DllInfo *dll)
 {
-    R_registerRoutines(dll, CEntries, NULL, NULL, NULL);
+    R_registerRoutines(dll, CEntries, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
 }